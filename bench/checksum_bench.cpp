@@ -0,0 +1,56 @@
+// Throughput of each checksum kernel the CPU supports, in GB/s, over
+// packet-sized and large buffers. Usage: checksum_bench [SECONDS_PER_RUN]
+
+#include "NetworkUtils.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace PortScanner;
+
+int main(int argc, char* argv[]) {
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 0.2;
+    const std::size_t sizes[] = {128, 576, 1500, 9000, 65535};
+    
+    // Start at an odd address, the kernels' unaligned case
+    std::vector<std::uint8_t> buffer(65535 + 1);
+    std::mt19937 rng(1071);
+    for (auto& byte : buffer) {
+        byte = static_cast<std::uint8_t>(rng());
+    }
+    const std::uint8_t* bytes = buffer.data() + 1;
+    
+    std::printf("%-8s", "kernel");
+    for (std::size_t size : sizes) {
+        std::printf("%10zu B", size);
+    }
+    std::printf("\n");
+    
+    for (const auto& [name, kernel] : NetworkUtils::checksum_kernels()) {
+        std::printf("%-8s", name.c_str());
+        
+        for (std::size_t size : sizes) {
+            // Batches of calls until the time is up; the sums feed a sink so
+            // the calls cannot be optimized away
+            using Clock = std::chrono::steady_clock;
+            const auto start = Clock::now();
+            volatile std::uint64_t sink = 0;
+            std::size_t bytes_summed = 0;
+            double elapsed = 0;
+            
+            while (elapsed < seconds) {
+                for (int i = 0; i < 256; ++i) {
+                    sink = sink + kernel(bytes, size);
+                }
+                bytes_summed += 256 * size;
+                elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            }
+            
+            std::printf("%8.2f GB/s", static_cast<double>(bytes_summed) / elapsed / 1e9);
+        }
+        std::printf("\n");
+    }
+    
+    return 0;
+}
\ No newline at end of file
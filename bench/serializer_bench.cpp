@@ -0,0 +1,68 @@
+// Time to write a large result set in each output format, with one thread
+// and with one per CPU. Usage: serializer_bench [RESULTS] [FILE]
+// (default: 10M results, written to /dev/null)
+
+#include "ResultSerializer.h"
+#include "ScanResults.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <thread>
+
+using namespace PortScanner;
+
+int main(int argc, char* argv[]) {
+    const std::size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    const std::string filename = argc > 2 ? argv[2] : "/dev/null";
+    const std::size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    
+    // A /16 swept over a few ports: mostly closed and filtered, one in
+    // twenty open with a service name, some of those needing escapes
+    const std::string services[] = {"http", "ssh", "https", "microsoft-ds", "say \"hi\" <b>"};
+    ScanResults results;
+    std::mt19937 rng(10000000);
+    for (std::size_t i = 0; i < rows; ++i) {
+        ScanResult result{};
+        result.host = "10.1." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256);
+        result.port = static_cast<Port>(1 + rng() % 1024);
+        result.status = PortStatus::CLOSED;
+        result.response_time = Duration{static_cast<long>(rng() % 500)};
+        const unsigned roll = rng() % 20;
+        if (roll == 0) {
+            result.status = PortStatus::OPEN;
+            result.service.name = services[rng() % std::size(services)];
+        } else if (roll < 8) {
+            result.status = PortStatus::FILTERED;
+        }
+        results.add_result(result);
+    }
+    
+    // The txt report's host/port order is built once and kept; build it
+    // here, so the first txt run is not charged for it
+    ResultSerializer(results, "txt", 1);
+    
+    std::printf("%zu results to %s\n", rows, filename.c_str());
+    std::printf("%-8s%14s%14s\n", "format", "1 thread", (std::to_string(cpus) + " threads").c_str());
+    
+    for (const std::string format : {"txt", "json", "xml", "ndjson"}) {
+        std::printf("%-8s", format.c_str());
+        
+        for (std::size_t threads : {std::size_t{1}, cpus}) {
+            using Clock = std::chrono::steady_clock;
+            std::ofstream file(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+            const auto start = Clock::now();
+            ResultSerializer(results, format, threads).write(file);
+            file.flush();
+            const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            
+            std::printf("%12.2f s", elapsed);
+        }
+        std::printf("\n");
+    }
+    
+    return 0;
+}
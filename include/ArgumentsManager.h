@@ -21,8 +21,9 @@ private:
     bool should_exit_ = false;
     
     void parse_arguments(int argc, char* argv[]);
+    void parse_merge_arguments(int argc, char* argv[]);
+    void parse_convert_arguments(int argc, char* argv[]);
     void validate_config();
-    std::vector<Port> parse_port_range(const std::string& port_str);
 };
 
 class ArgumentError : public std::runtime_error {
@@ -2,9 +2,20 @@
 
 #include "Common.h"
 #include "ScanResults.h"
+#include "TimerWheel.h"
+#include "IoUring.h"
+#include "RateLimiter.h"
+#include "RttEstimator.h"
+#include "ScanTargets.h"
+#include "ResultSink.h"
 #include <sys/epoll.h>
+#include <netinet/in.h>
+#include <condition_variable>
 #include <future>
 #include <atomic>
+#include <mutex>
+#include <deque>
+#include <thread>
 
 namespace PortScanner {
 
@@ -21,6 +32,9 @@ public:
     // Cancel ongoing scan
     void cancel();
     
+    // Hand final results to this sink as they come in (null: none)
+    void set_sink(ResultSink* sink) { sink_ = sink; }
+    
     // Get current scan statistics
     struct ScanStats {
         std::size_t total_ports;
@@ -32,40 +46,119 @@ public:
     };
     
     ScanStats get_stats() const;
+    
+    // True if a scan with this config runs on io_uring: asked for, and the
+    // kernel has every op it needs (TCP_SYNCNT from the ring with retries);
+    // otherwise it runs on epoll
+    static bool uses_io_uring(const ScanConfig& config);
 
 private:
     ScanConfig config_;
-    int epoll_fd_;
     std::atomic<bool> cancelled_{false};
     std::atomic<std::size_t> completed_ports_{0};
     std::atomic<std::size_t> open_ports_{0};
+    std::atomic<std::size_t> in_flight_{0};
+    std::mutex progress_mutex_;
+    std::unique_ptr<RateLimiter> limiter_;  // shared by all reactors; null when unlimited
+    std::deque<RttEstimator> rtt_;          // per target, sets each new probe's deadline
+    ProbeSpace pass_;                       // (host, port) pairs of the current pass
+    std::size_t total_probes_ = 0;          // targets x ports
+    ResultSink* sink_ = nullptr;
+    bool final_pass_ = true;                // no retry pass follows the current one
+    
+    // Open ports wait here for service detection and banner grabbing, which
+    // a small pool of threads works off so no reactor blocks on a banner
+    struct Detection {
+        ProbeTarget probe;
+        ScanResult result;
+    };
+    static constexpr std::size_t DETECTION_THREADS = 16;
+    std::mutex detect_mutex_;               // guards everything below
+    std::condition_variable detect_cv_;
+    std::deque<Detection> detect_queue_;
+    std::vector<std::thread> detectors_;    // grown on demand, up to DETECTION_THREADS
+    std::size_t idle_detectors_ = 0;
+    bool detect_done_ = false;              // no more open ports will be queued
+    ScanResults detected_;
     
-    // Connection management
+    // Connection management: a fixed window of slots, refilled as soon
+    // as any connect completes or times out
     struct Connection {
-        int sockfd;
-        Port port;
+        int sockfd = -1;
+        std::uint32_t host = 0;
+        Port port = 0;
         std::chrono::steady_clock::time_point start_time;
+        std::chrono::steady_clock::time_point deadline;   // epoll: on the reactor's clock
         bool connected = false;
+        
+        // io_uring backend: operands must outlive submission, and the
+        // probe is classified once all of its completions have arrived
+        sockaddr_in addr{};
+        __kernel_timespec timeout{};
+        int pending = 0;
+        int socket_res = 0;
+        int option_res = 0;
+        int connect_res = 0;
     };
     
-    std::vector<Connection> connections_;
-    std::unordered_map<int, std::size_t> fd_to_connection_;
+    // One event loop per thread; each owns its epoll fd, connection table
+    // and results, and scans every Nth probe starting at its own index
+    struct Reactor {
+        int epoll_fd = -1;
+        std::vector<Connection> connections;
+        std::vector<std::size_t> free_slots;
+        TimerWheel timers;
+        TimerWheel::Clock::time_point clock;  // epoll: time that counts toward deadlines
+        std::vector<TimerWheel::TimerId> expired;
+        std::size_t next_index = 0;
+        std::size_t stride = 1;
+        std::size_t in_flight = 0;
+        ScanResults results;
+        std::unique_ptr<IoUring> ring;  // set when using the io_uring backend
+        std::vector<std::size_t> finished;  // io_uring: slots with every completion in
+        __kernel_timespec pace{};       // io_uring wake-up for the next rate token
+        bool pace_armed = false;
+    };
     
     // Core async methods
-    void setup_epoll();
-    void cleanup_epoll();
+    ScanResults run_pass(const ProgressCallback& progress_cb);
+    void setup_reactor(Reactor& reactor, std::size_t index, std::size_t count,
+                       std::size_t window, bool use_io_uring);
+    void cleanup_reactor(Reactor& reactor);
+    void run_reactor(Reactor& reactor, const ProgressCallback& progress_cb);
+    void run_reactor_uring(Reactor& reactor, const ProgressCallback& progress_cb);
+    std::size_t resolve_reactor_count() const;
+    
+    void fill_window(Reactor& reactor, const ProgressCallback& progress_cb);
+    bool has_pending(const Reactor& reactor) const;
+    int pacing_timeout_ms(const Reactor& reactor, int timeout_ms);
+    void arm_pacing(Reactor& reactor);
+    void record_outcome(const Connection& conn, bool answered);
+    bool open_connection(Reactor& reactor, std::size_t slot, const ProbeTarget& probe);
+    void release_connection(Reactor& reactor, std::size_t slot);
+    void expire_connections(Reactor& reactor, const ProgressCallback& progress_cb);
+    void handle_connection_event(Reactor& reactor, const epoll_event& event);
+    void detect_open_service(ScanResult& result);
+    void queue_detection(const ProbeTarget& probe, ScanResult result);
+    void detection_loop();
+    ScanResults finish_detection();
     
-    bool create_connections(const std::vector<Port>& ports);
-    void process_events(ScanResults& results, ProgressCallback progress_cb);
-    void handle_connection_event(const epoll_event& event, ScanResults& results);
+    // io_uring backend
+    bool queue_probe(Reactor& reactor, std::size_t slot, const ProbeTarget& probe);
+    void handle_completion(Reactor& reactor, const io_uring_cqe& cqe);
+    void finish_probe(Reactor& reactor, std::size_t slot);
+    io_uring_sqe* next_sqe(Reactor& reactor);
+    void report_progress(const ProgressCallback& progress_cb);
+    void store_result(Reactor& reactor, const ProbeTarget& probe, ScanResult result);
+    ScanResult make_result(const ProbeTarget& probe, PortStatus status,
+                           std::chrono::steady_clock::time_point start_time);
     
     // IPv6 support
-    int create_socket_for_target();
+    int create_socket_for_target(const IPAddress& host);
     bool is_ipv6_address(const IPAddress& ip);
     
     // Performance optimizations
     void set_socket_options(int sockfd);
-    void batch_connect(std::size_t batch_size = 1000);
 };
 
 } // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common.h"
+#include "ResultSink.h"
+#include "ScanResults.h"
+#include "ScanTargets.h"
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace PortScanner {
+
+// On-disk snapshot of a running scan, for --resume, in two files. The
+// checkpoint holds the scan setup with its seed and shard, the full-pass
+// probe positions not yet answered (as [begin, end) runs, i.e. the iterator
+// position plus the probes still outstanding behind it) and the length of
+// its results log. The log, <checkpoint>.results, has every result so far
+// as NDJSON lines, service detail and banner included.
+//
+// Engines hand each final result to record(), which formats its line and
+// appends it, with the probe's position, to a pending buffer under a short
+// lock. A background thread swaps that buffer out every interval (or once
+// it passes FLUSH_BYTES), appends its lines to the log, marks their
+// positions in a bitmap only the writer touches, and rewrites the
+// checkpoint into a temporary that is renamed over the old one. A snapshot
+// thus costs what came in since the last one plus the pending runs, an
+// engine never waits on the disk, and a crash mid-write leaves the previous
+// checkpoint intact; log lines past the length it records are dropped on
+// load.
+class Checkpoint : public ResultSink {
+public:
+    static constexpr std::size_t FLUSH_BYTES = 1024 * 1024;
+    
+    // What a checkpoint holds; config.pending lists the runs left
+    struct State {
+        ScanConfig config;
+        ScanResults results;
+    };
+    
+    // Snapshots config.checkpoint_file; completed are the results of the run
+    // being resumed (their probes are not pending). Throws std::runtime_error
+    // if the files cannot be written.
+    Checkpoint(const ScanConfig& config, const ScanResults& completed);
+    ~Checkpoint() override;
+    
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+    
+    // Final outcome of one probe; thread-safe. A probe that failed (UNKNOWN)
+    // is done too: --resume does not send it again.
+    void record(const ProbeTarget& probe, const ScanResult& result) override;
+    
+    // Write a snapshot now, e.g. after an interrupt
+    bool save();
+    
+    // The scan finished: write every result, with nothing left pending
+    bool save_complete(const ScanResults& results);
+    
+    // Throws std::runtime_error if the files are missing or not a checkpoint
+    static State load(const std::string& filename);
+    
+    // The results log of the checkpoint in filename
+    static std::string log_file(const std::string& filename) { return filename + ".results"; }
+
+private:
+    ScanConfig config_;
+    ProbeSpace base_;                       // the pass being checkpointed, before any resume
+    
+    // Lines recorded since the writer last took them
+    std::mutex mutex_;                      // guards pending_, pending_lines_ and stopping_
+    std::string pending_;
+    std::vector<std::pair<std::uint64_t, std::size_t>> pending_lines_;  // full-pass position and end
+                                                                        // in pending_ of each line
+    bool stopping_ = false;
+    std::condition_variable wake_;
+    
+    std::mutex write_mutex_;                // one writer at a time; guards the rest
+    std::vector<std::uint64_t> done_;       // bit per full-pass position in the log
+    std::ofstream log_;
+    std::uint64_t log_size_ = 0;            // bytes of it written so far
+    std::string batch_;                     // pending_ and pending_lines_ as swapped out
+    std::vector<std::pair<std::uint64_t, std::size_t>> batch_lines_;
+    
+    std::thread writer_;
+    
+    void write_loop();
+    bool append_pending();
+    bool rewrite_log(const ScanResults& results);
+    bool write_file(const std::vector<std::pair<std::uint64_t, std::uint64_t>>& pending) const;
+    static std::vector<std::pair<std::uint64_t, std::uint64_t>> pending_runs(const std::vector<std::uint64_t>& done,
+                                                                               std::uint64_t size);
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -6,11 +6,11 @@
 #include <memory>
 #include <chrono>
 #include <unordered_map>
+#include "PortSet.h"
 
 namespace PortScanner {
 
-// Type aliases for better readability
-using Port = std::uint16_t;
+// Type aliases for better readability (Port comes with PortSet.h)
 using IPAddress = std::string;
 using Duration = std::chrono::milliseconds;
 
@@ -18,7 +18,9 @@ using Duration = std::chrono::milliseconds;
 constexpr Port MIN_PORT = 1;
 constexpr Port MAX_PORT = 65535;
 constexpr Duration DEFAULT_TIMEOUT{3000};
+constexpr Duration DEFAULT_MIN_RTT_TIMEOUT{100};
 constexpr std::size_t DEFAULT_THREAD_COUNT = 100;
+constexpr std::size_t MAX_TARGETS = std::size_t{1} << 20;   // hosts per scan (a /12)
 
 // IP version support
 enum class IPVersion {
@@ -33,16 +35,25 @@ enum class ScanType {
     TCP_SYN,
     UDP,
     TCP_ACK,
-    TCP_FIN
+    TCP_FIN,
+    TCP_NULL,
+    TCP_XMAS
 };
 
-// Port status
-enum class PortStatus {
+// Async engine backends
+enum class AsyncBackend {
+    EPOLL,
+    IO_URING
+};
+
+// Port status; one byte, as ScanResults stores one per result
+enum class PortStatus : std::uint8_t {
     OPEN,
     CLOSED,
     FILTERED,
     UNKNOWN,
-    OPEN_FILTERED
+    OPEN_FILTERED,
+    UNFILTERED
 };
 
 // Service information structure
@@ -62,22 +73,59 @@ struct ScanResult {
     ServiceInfo service;
     std::string banner;
     IPVersion ip_version = IPVersion::IPv4;
+    IPAddress host;
 };
 
 // Configuration structure for advanced features
 struct ScanConfig {
-    IPAddress target;
-    std::vector<Port> ports;
+    IPAddress target;               // as given: hosts, CIDR blocks and ranges, comma-separated
+    std::vector<IPAddress> targets; // target expanded into single addresses
+    PortSet ports;
     ScanType scan_type = ScanType::TCP_CONNECT;
     IPVersion ip_version = IPVersion::AUTO;
     Duration timeout = DEFAULT_TIMEOUT;
+    Duration min_rtt_timeout = DEFAULT_MIN_RTT_TIMEOUT;  // floor of the RTT-derived timeout
+    Duration max_rtt_timeout{0};                        // its ceiling; 0 = timeout
     std::size_t thread_count = DEFAULT_THREAD_COUNT;
+    std::size_t max_retries = 0;    // re-probe passes over timed-out ports; 0 = kernel SYN retries
+    Duration retry_delay{0};        // pause before each re-probe pass
+    std::size_t reactor_count = 0;  // async event loops; 0 = online CPUs
+    AsyncBackend async_backend = AsyncBackend::EPOLL;
+    bool stateless = false;         // raw SYN scan without per-probe timing state
+    bool rx_ring = true;            // raw replies via a TPACKET_V3 ring, else a raw socket
+    bool tx_ring = true;            // raw probes via a PACKET_TX_RING, else a raw socket
+    std::size_t rate = 0;           // probes per second; 0 = unlimited
+    bool adaptive_rate = false;     // AIMD: back off on loss spikes, creep back up otherwise
+    bool randomize = true;          // visit (host, port) pairs in pseudo-random order
+    std::uint64_t seed = 0;         // key of that order; 0 = pick one per scan
+    std::size_t shard_index = 0;    // --shard i/N: probe every N-th pair of that order,
+    std::size_t shard_count = 1;    // starting at pair i - 1
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> pending;  // resumed scan: [begin, end) runs of
+                                                                   // full-pass probes left; empty = all
+    bool discover = false;          // ping targets first, port scan only the live ones
+    std::vector<Port> ping_ports{80, 443};  // TCP ports the discovery stage connects to
     bool verbose = false;
     bool service_detection = true;
     bool banner_grabbing = true;
     std::string config_file;
     std::string output_format = "txt";
     std::string output_file;
+    bool stream = false;                   // write NDJSON to output_file as results arrive
+    std::vector<std::string> merge_files;  // "merge" subcommand: shard outputs to combine
+    std::string convert_file;              // "convert" subcommand: results file to rewrite
+    std::string checkpoint_file;           // periodic snapshot of the scan; empty = none
+    std::chrono::seconds checkpoint_interval{30};
+    std::string resume_file;               // checkpoint to continue from
+};
+
+// Packet counters from a raw-socket scan
+struct PacketStats {
+    std::string send_path;          // "ring" or "socket"
+    std::string receive_path;
+    std::size_t packets_sent = 0;
+    std::size_t packets_received = 0;
+    std::chrono::nanoseconds send_time{0};
+    std::chrono::nanoseconds receive_time{0};
 };
 
 // Service detection patterns
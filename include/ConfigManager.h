@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include <iosfwd>
 
 namespace PortScanner {
 
@@ -15,16 +16,21 @@ public:
     // Create default configuration
     static ScanConfig create_default_config();
     
+    // JSON form of a config on any stream (checkpoints embed it)
+    static ScanConfig read_json(std::istream& in);
+    static void write_json(const ScanConfig& config, std::ostream& out);
+    
     // Merge command line args with config file
     static ScanConfig merge_configs(const ScanConfig& file_config, 
                                    const ScanConfig& cli_config);
     
     // Helper methods
-    static std::vector<Port> parse_port_string(const std::string& port_str);
     static ScanType string_to_scan_type(const std::string& type_str);
     static std::string scan_type_to_string(ScanType type);
     static IPVersion string_to_ip_version(const std::string& version_str);
     static std::string ip_version_to_string(IPVersion version);
+    static AsyncBackend string_to_backend(const std::string& backend_str);
+    static std::string backend_to_string(AsyncBackend backend);
 
 private:
     // JSON support (simplified)
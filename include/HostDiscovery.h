@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Common.h"
+#include "RateLimiter.h"
+#include "RttEstimator.h"
+#include "TimerWheel.h"
+#include <netinet/in.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+namespace PortScanner {
+
+// Outcome of the discovery stage, reported apart from the port scan
+struct DiscoveryStats {
+    std::size_t hosts = 0;                      // targets to discover
+    std::size_t live = 0;                       // targets that answered (or were not pinged)
+    std::size_t probes_sent = 0;
+    std::chrono::nanoseconds elapsed{0};
+    std::chrono::nanoseconds mean_latency{0};   // first probe to first answer, over answering hosts
+    std::chrono::nanoseconds max_latency{0};
+};
+
+// Host discovery ahead of a port scan (--discover). Every IPv4 target gets
+// an ICMP echo request, a UDP datagram to a port that is almost surely
+// closed and a TCP connect to each --ping-ports port. Any answer marks the
+// host live: an echo reply, an ICMP port unreachable, a SYN-ACK or a RST.
+// Only the live hosts go on to the port scan engines.
+//
+// One epoll loop drives it, as in an AsyncScanner reactor: pings go out in
+// batches, connects are kept to a fixed window with TimerWheel deadlines,
+// and a host is not probed again once it answered. The wait is the pooled
+// RTT estimate, --rate caps the probes and IPv6 targets are passed through.
+// Echoes use a raw ICMP socket, or an unprivileged ping socket without root.
+class HostDiscovery {
+public:
+    explicit HostDiscovery(const ScanConfig& config);
+    ~HostDiscovery();
+    
+    HostDiscovery(const HostDiscovery&) = delete;
+    HostDiscovery& operator=(const HostDiscovery&) = delete;
+    
+    // Indices into config.targets of the live hosts, in target order
+    std::vector<std::uint32_t> run();
+    void cancel();
+    
+    const DiscoveryStats& stats() const noexcept { return stats_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr std::size_t BATCH_SIZE = 64;
+    
+    struct Host {
+        in_addr_t address = 0;
+        bool ipv4 = false;
+        bool live = false;
+        std::int64_t first_sent_ns = 0;
+        std::int64_t latency_ns = -1;           // -1 until the first answer
+    };
+    
+    struct Connection {
+        int fd = -1;
+        std::uint32_t host = 0;
+    };
+    
+    ScanConfig config_;
+    std::vector<Host> hosts_;
+    std::unordered_map<in_addr_t, std::uint32_t> index_;
+    std::size_t answered_ = 0;
+    std::size_t pinged_ = 0;                    // IPv4 hosts, the ones that can answer
+    
+    int epoll_fd_ = -1;
+    int icmp_fd_ = -1;
+    bool icmp_raw_ = false;                     // raw socket: replies carry the IP header
+    int udp_fd_ = -1;
+    std::uint16_t echo_id_ = 0;
+    
+    std::vector<Connection> connections_;
+    std::vector<std::size_t> free_slots_;
+    TimerWheel timers_;
+    std::vector<TimerWheel::TimerId> expired_;
+    
+    std::unique_ptr<RateLimiter> limiter_;      // null when the rate is unlimited
+    RttEstimator rtt_;
+    std::atomic<bool> cancelled_{false};
+    DiscoveryStats stats_;
+    
+    void send_pings(std::uint32_t host);
+    void open_connection(std::uint32_t host, Port port);
+    void release_connection(std::size_t slot);
+    void handle_connection(std::size_t slot, std::uint32_t events);
+    void drain_icmp();
+    void drain_udp();
+    void mark_live(std::uint32_t host);
+    bool take_token();
+    
+    static std::int64_t now_ns();
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Common.h"
+#include <linux/io_uring.h>
+
+namespace PortScanner {
+
+// Minimal io_uring wrapper over the raw syscalls (no liburing dependency).
+// One ring is owned by a single thread; nothing here is thread-safe.
+class IoUring {
+public:
+    // Throws std::runtime_error if the kernel refuses to set up the ring
+    explicit IoUring(unsigned entries, unsigned fixed_files = 0);
+    ~IoUring();
+    
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+    
+    // True if the running kernel supports every op the connect scan needs
+    static bool is_supported();
+    
+    // True if the kernel can also set socket options from the ring
+    // (IORING_OP_URING_CMD with SOCKET_URING_OP_SETSOCKOPT, Linux 6.7)
+    static bool supports_setsockopt();
+    
+    // Make sqe a setsockopt on fixed file index; optval must stay valid
+    // until the op completes
+    static void prep_setsockopt(io_uring_sqe* sqe, int index, int level, int optname,
+                                const void* optval, unsigned optlen);
+    
+    // Next free submission entry, zeroed; nullptr when the SQ is full
+    io_uring_sqe* get_sqe();
+    unsigned sq_space_left() const;
+    
+    // Submit queued entries and optionally wait for completions
+    int submit(unsigned wait_nr = 0);
+    
+    // Pop one completion if available
+    bool pop_cqe(io_uring_cqe& cqe);
+
+private:
+    int ring_fd_ = -1;
+    io_uring_params params_{};
+    
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    std::size_t sq_ring_size_ = 0;
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+    
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    
+    unsigned sqe_tail_ = 0;     // local tail, published on submit
+    unsigned sqe_head_ = 0;
+    
+    void map_rings();
+    void register_sparse_files(unsigned count);
+    void release();
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -3,20 +3,41 @@
 #include "Common.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <utility>
 
 namespace PortScanner {
 
+// Where a packet to some target leaves the host at the link layer
+struct LinkAddress {
+    int ifindex = 0;
+    std::uint8_t mac[6] = {};       // next-hop hardware address (zero on loopback)
+    bool loopback = false;
+};
+
 class NetworkUtils {
 public:
     static bool is_valid_ipv4(const IPAddress& ip);
     static IPAddress resolve_hostname(const std::string& hostname);
+    
+    // Expand a target list into single addresses, in order and without
+    // duplicates. Items are comma-separated: an address or hostname, a CIDR
+    // block (10.0.0.0/24), a range (10.0.0.1-10.0.1.5) or a last-octet range
+    // (10.0.0.1-50). Throws std::runtime_error on a bad item or more than
+    // MAX_TARGETS hosts
+    static std::vector<IPAddress> expand_targets(const std::string& spec);
     static IPAddress get_local_ip();
+    static IPAddress get_source_ip(const IPAddress& target);
+    
+    // Outgoing interface and next-hop MAC for target (from the routing and
+    // neighbour tables); throws std::runtime_error if it cannot be resolved
+    static LinkAddress resolve_link(const IPAddress& target);
     static std::string get_service_name(Port port, const std::string& protocol = "tcp");
     
     // Socket utilities
     static int create_tcp_socket();
     static int create_udp_socket();
     static int create_raw_socket();
+    static int create_packet_socket();
     
     static bool set_socket_timeout(int sockfd, Duration timeout);
     static bool set_socket_nonblocking(int sockfd);
@@ -24,6 +45,21 @@ public:
     // Address utilities
     static sockaddr_in create_sockaddr(const IPAddress& ip, Port port);
     static std::string sockaddr_to_string(const sockaddr_in& addr);
+    
+    // Internet checksum (RFC 1071) helpers for crafted packets. Buffers of
+    // 128 bytes and up are summed with the widest SIMD kernel the CPU supports
+    static std::uint16_t checksum(const void* data, std::size_t length, std::uint32_t initial = 0);
+    static std::uint16_t transport_checksum(in_addr_t source, in_addr_t destination, std::uint8_t protocol,
+                                            const void* segment, std::size_t length);
+    
+    // RFC 1624 incremental update: a field (as stored in the packet) changed from old_value to new_value
+    static std::uint16_t checksum_adjust(std::uint16_t check, std::uint32_t old_value, std::uint32_t new_value);
+    
+    // A checksum kernel returns the unfolded one's complement sum of a buffer
+    // in native byte order. These are the kernels this CPU can run, scalar
+    // first and the one checksum() uses last; for tests and benchmarks
+    using ChecksumKernel = std::uint64_t (*)(const std::uint8_t* bytes, std::size_t length);
+    static std::vector<std::pair<std::string, ChecksumKernel>> checksum_kernels();
 
 private:
     NetworkUtils() = default;
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Common.h"
+#include "NetworkUtils.h"
+#include <netinet/in.h>
+#include <functional>
+
+namespace PortScanner {
+
+// AF_PACKET receive path backed by a TPACKET_V3 PACKET_RX_RING. The kernel
+// fills whole blocks of packets in the mmap'd ring; the reader walks a
+// block in place (no copy, no syscall per packet) and hands it back.
+// A BPF filter keeps everything but ICMP and packets from the scanned
+// network out.
+class PacketRing {
+public:
+    // Called with the IP header of each received packet
+    using PacketHandler = std::function<void(const std::uint8_t* packet, std::size_t length)>;
+    
+    // Throws std::runtime_error without CAP_NET_RAW or TPACKET_V3 support
+    // Packets from network/netmask (network order) pass; a /32 for one peer
+    PacketRing(in_addr_t network, in_addr_t netmask);
+    ~PacketRing();
+    
+    PacketRing(const PacketRing&) = delete;
+    PacketRing& operator=(const PacketRing&) = delete;
+    
+    // Wait up to timeout_ms for a filled block, then hand every packet of
+    // every ready block to the handler. Returns the number of packets seen.
+    std::size_t receive(int timeout_ms, const PacketHandler& handler);
+
+private:
+    static constexpr unsigned RING_BLOCK_SIZE = 1u << 20;
+    static constexpr unsigned RING_BLOCK_COUNT = 16;
+    static constexpr unsigned RING_FRAME_SIZE = 2048;
+    static constexpr unsigned BLOCK_TIMEOUT_MS = 10;   // retire partly filled blocks
+    
+    int fd_ = -1;
+    std::uint8_t* ring_ = nullptr;
+    std::size_t ring_size_ = 0;
+    unsigned current_block_ = 0;
+    
+    void attach_filter(in_addr_t network, in_addr_t netmask);
+    void release();
+};
+
+// AF_PACKET transmit path backed by a TPACKET_V2 PACKET_TX_RING. Packets
+// (starting at the IP header) are written straight into mmap'd frames and
+// the kernel is kicked once per batch instead of once per packet.
+class PacketTxRing {
+public:
+    // Throws std::runtime_error without CAP_NET_RAW or TX ring support
+    explicit PacketTxRing(const LinkAddress& link);
+    ~PacketTxRing();
+    
+    PacketTxRing(const PacketTxRing&) = delete;
+    PacketTxRing& operator=(const PacketTxRing&) = delete;
+    
+    // Free frame to write up to frame_capacity() bytes into; nullptr while
+    // every frame is still queued for the kernel
+    std::uint8_t* acquire();
+    std::size_t frame_capacity() const noexcept;
+    
+    // Queue the acquired frame; the batch is flushed when full
+    void commit(std::size_t length);
+    
+    // Hand every queued frame to the kernel
+    void flush();
+    
+    // Block until a frame is free again or timeout_ms passes
+    void wait(int timeout_ms);
+
+private:
+    static constexpr unsigned RING_BLOCK_SIZE = 1u << 16;
+    static constexpr unsigned RING_BLOCK_COUNT = 64;
+    static constexpr unsigned RING_FRAME_SIZE = 256;
+    static constexpr unsigned FRAME_COUNT = (RING_BLOCK_SIZE / RING_FRAME_SIZE) * RING_BLOCK_COUNT;
+    static constexpr unsigned BATCH_SIZE = 64;
+    
+    int fd_ = -1;
+    std::uint8_t* ring_ = nullptr;
+    std::size_t ring_size_ = 0;
+    unsigned current_frame_ = 0;
+    unsigned queued_ = 0;
+    LinkAddress link_;
+    
+    void release();
+};
+
+} // namespace PortScanner
\ No newline at end of file
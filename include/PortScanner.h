@@ -4,9 +4,17 @@
 #include "ScanResults.h"
 #include "ServiceDetector.h"
 #include "AsyncScanner.h"
+#include "RawScanner.h"
+#include "UdpScanner.h"
+#include "Checkpoint.h"
+#include "ResultStream.h"
+#include "HostDiscovery.h"
 #include <functional>
 #include <future>
 #include <memory>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 namespace PortScanner {
 
@@ -20,9 +28,13 @@ public:
     ScanResults scan_ports(ProgressCallback progress_cb = nullptr);
     std::future<ScanResults> scan_ports_async(ProgressCallback progress_cb = nullptr);
     
-    // Single port scanning
+    // Single port scanning (first target)
     ScanResult scan_single_port(Port port, ScanType scan_type = ScanType::TCP_CONNECT);
     
+    // Results carried over from a resumed checkpoint: not probed again, but
+    // part of the scan's results and of its checkpoints
+    void set_resumed_results(ScanResults results) { resumed_ = std::move(results); }
+    
     // Configuration management
     void update_config(const ScanConfig& config);
     const ScanConfig& get_config() const { return config_; }
@@ -35,19 +47,67 @@ public:
     
     // Cancel ongoing scan
     void cancel_scan();
+    
+    // Packet counters of the last raw-socket scan (empty for other scans)
+    PacketStats packet_stats() const;
+    
+    // Outcome of the --discover stage of the last scan (hosts = 0 if none ran)
+    const DiscoveryStats& discovery_stats() const { return discovery_stats_; }
+    
+    // Lines the last --stream scan wrote to config.output_file
+    std::size_t stream_lines() const { return stream_lines_; }
 
 private:
     ScanConfig config_;
     std::unique_ptr<ServiceDetector> service_detector_;
     std::unique_ptr<AsyncScanner> async_scanner_;
+    std::unique_ptr<RawScanner> raw_scanner_;
+    std::unique_ptr<UdpScanner> udp_scanner_;
+    std::unique_ptr<HostDiscovery> discovery_;
+    DiscoveryStats discovery_stats_;
+    std::mutex engine_mutex_;               // engines may be cancelled while they are being created
+    std::unique_ptr<Checkpoint> checkpoint_;  // while a scan with --checkpoint runs
+    std::unique_ptr<ResultStream> stream_;    // while a scan with --stream runs
+    ResultSinks sinks_;                       // the two above, whichever are set
+    std::size_t stream_lines_ = 0;
+    ScanResults resumed_;
+    std::deque<RttEstimator> rtt_;          // connect timeouts of the threaded fallback, per target
     bool high_performance_mode_ = false;
+    std::atomic<bool> cancelled_{false};    // stops the threaded fallback
     
     // Legacy scanning methods (for compatibility)
-    ScanResult tcp_connect_scan(Port port);
-    ScanResult tcp_syn_scan(Port port);
-    ScanResult udp_scan(Port port);
-    ScanResult tcp_ack_scan(Port port);
-    ScanResult tcp_fin_scan(Port port);
+    ScanResult scan_probe(const ProbeTarget& probe, ScanType scan_type);
+    ScanResult tcp_connect_scan(const ProbeTarget& probe);
+    ScanResult tcp_syn_scan(const ProbeTarget& probe);
+    ScanResult udp_scan(const ProbeTarget& probe);
+    ScanResult tcp_ack_scan(const ProbeTarget& probe);
+    ScanResult tcp_fin_scan(const ProbeTarget& probe);
+    
+    // One-probe run of the raw engine; throws without raw socket privileges
+    ScanResult raw_probe_scan(const ProbeTarget& probe, ScanType scan_type);
+    
+    // Single-probe copy of the config, for one-shot engine runs
+    ScanConfig single_probe_config(const ProbeTarget& probe) const;
+    
+    // Whole-scan engines for probe types that need raw sockets or batching
+    bool uses_raw_engine() const;
+    bool uses_udp_engine() const;
+    bool run_raw_scan(ScanResults& results, ProgressCallback progress_cb);
+    bool run_udp_scan(ScanResults& results, ProgressCallback progress_cb);
+    
+    // What engines hand their final results to; null without --checkpoint and --stream
+    ResultSink* sink() { return sinks_.empty() ? nullptr : &sinks_; }
+    
+    // Narrow config_.targets down to the hosts that answer a ping
+    void discover_hosts();
+    
+    // The whole scan, on whichever engine fits its probe type
+    ScanResults run_engines(ProgressCallback progress_cb);
+    
+    // One pass of blocking per-port scans over a thread pool; timeouts reach
+    // the sinks only in the final pass (earlier ones may still be retried)
+    ScanResults run_threaded_pass(const ProbeSpace& probes, const ProgressCallback& progress_cb,
+                                  std::atomic<std::size_t>& completed, RateLimiter* limiter, bool final_pass);
     
     // Helper methods
     bool is_valid_ip(const IPAddress& ip);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PortScanner {
+
+using Port = std::uint16_t;
+
+// Set of TCP/UDP ports as a 65536-bit bitmap (8 KiB). Ranges are inserted
+// and removed a 64-bit word at a time, iteration skips empty words and
+// yields ports in ascending order, and include/exclude lists combine with
+// word-wise set operations. The bitmap is shared copy-on-write: copying a
+// ScanConfig into an engine or a pass copies a pointer, and only a set
+// that is actually modified gets its own bitmap.
+class PortSet {
+public:
+    static constexpr std::size_t WORDS = 65536 / 64;
+    
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Port;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Port*;
+        using reference = Port;
+        
+        const_iterator() = default;
+        
+        Port operator*() const { return static_cast<Port>(word_ * 64 + __builtin_ctzll(bits_)); }
+        const_iterator& operator++() {
+            bits_ &= bits_ - 1;
+            skip_empty();
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const {
+            return word_ == other.word_ && bits_ == other.bits_;
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    
+    private:
+        friend class PortSet;
+        const PortSet* set_ = nullptr;
+        std::size_t word_ = WORDS;
+        std::uint64_t bits_ = 0;
+        
+        const_iterator(const PortSet* set, std::size_t word);
+        void skip_empty();
+    };
+    
+    PortSet() = default;
+    PortSet(std::initializer_list<Port> ports);
+    
+    // Port specification such as "22,80,443,1000-2000"; an open range end
+    // means the lowest or highest port ("-1024", "60000-"). Throws
+    // std::runtime_error on anything else or on a port outside 1-65535.
+    static PortSet parse(const std::string& spec);
+    
+    // The n most often open TCP ports, most common first (n <= top_count())
+    static PortSet top(std::size_t n);
+    static std::size_t top_count();
+    
+    void insert(Port port);
+    void insert_range(Port first, Port last);   // inclusive
+    void erase(Port port);
+    void erase_range(Port first, Port last);
+    void clear();
+    
+    bool contains(Port port) const {
+        return words_ && ((*words_)[port / 64] >> (port % 64)) & 1;
+    }
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    
+    // Raw bitmap word i (ports 64i .. 64i+63), for rank tables
+    std::uint64_t word(std::size_t index) const { return words_ ? (*words_)[index] : 0; }
+    
+    PortSet& operator|=(const PortSet& other);   // union
+    PortSet& operator&=(const PortSet& other);   // intersection
+    PortSet& operator-=(const PortSet& other);   // difference, e.g. an exclude list
+    
+    bool operator==(const PortSet& other) const;
+    bool operator!=(const PortSet& other) const { return !(*this == other); }
+    
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(); }
+    
+    std::vector<Port> to_vector() const;
+    
+    // Compact specification ("1-1024,8080") that parse() reads back
+    std::string to_string() const;
+
+private:
+    using Words = std::array<std::uint64_t, WORDS>;
+    
+    std::shared_ptr<Words> words_;   // null while empty; shared by copies until one modifies it
+    std::size_t size_ = 0;
+    
+    // Bitmap safe to modify: copied first if another set shares it
+    Words& mutable_words();
+    void recount();
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Common.h"
+#include <netinet/in.h>
+
+namespace PortScanner {
+
+// Keyed SipHash-2-4 cookie that encodes a probe's identity in the TCP
+// sequence number and source port, so replies can be matched to probes
+// without keeping any per-probe state.
+class ProbeCookie {
+public:
+    // Source ports are drawn from the IANA ephemeral range
+    static constexpr Port SOURCE_PORT_BASE = 32768;
+    static constexpr Port SOURCE_PORT_SPAN = 28232;
+    
+    struct Tag {
+        std::uint32_t seq;
+        Port source_port;
+    };
+    
+    // Random key from std::random_device
+    ProbeCookie();
+    ProbeCookie(std::uint64_t key0, std::uint64_t key1);
+    
+    // Sequence number and source port for a probe to ip:port (network-order ip)
+    Tag make(in_addr_t ip, Port port) const;
+    
+    // True if a reply from ip:port to source_port carries value == seq + offset
+    // (a SYN is acknowledged with seq + 1, an RST answering an ACK echoes seq)
+    bool verify(in_addr_t ip, Port port, Port source_port, std::uint32_t value, std::uint32_t offset = 1) const;
+
+private:
+    std::uint64_t key0_;
+    std::uint64_t key1_;
+    
+    std::uint64_t siphash(std::uint64_t message) const;
+};
+
+} // namespace PortScanner
\ No newline at end of file
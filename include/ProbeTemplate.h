@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Common.h"
+#include <netinet/in.h>
+#include <array>
+
+namespace PortScanner {
+
+// Pre-built IPv4/TCP probe. Headers and checksums are filled in once per
+// scan; each probe copies the template and patches only the destination
+// address, ports and sequence number, fixing both checksums with RFC 1624
+// incremental updates instead of summing the packet again. Probes with the
+// ACK flag carry the sequence number in the acknowledgement field as well.
+class ProbeTemplate {
+public:
+    // tcp_flags as in the TCP header (TH_SYN, TH_ACK, ...); SYNs carry an MSS option
+    ProbeTemplate(in_addr_t source, in_addr_t destination, std::uint8_t tcp_flags);
+    
+    std::size_t size() const noexcept { return length_; }
+    
+    // Write one probe (size() bytes) to buffer; addresses in network order
+    void build(std::uint8_t* buffer, in_addr_t destination, Port source_port,
+               Port destination_port, std::uint32_t seq) const;
+
+private:
+    std::array<std::uint8_t, 64> packet_{};
+    std::size_t length_ = 0;
+    in_addr_t destination_ = 0;
+    std::uint8_t flags_ = 0;
+};
+
+} // namespace PortScanner
\ No newline at end of file
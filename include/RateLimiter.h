@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Common.h"
+#include <atomic>
+#include <mutex>
+
+namespace PortScanner {
+
+// Token bucket capping the probe rate of a whole scan; every sender thread
+// of the engine in use draws from the same bucket. The bucket holds 10 ms
+// worth of tokens, so batched senders can still fill their batches.
+//
+// In adaptive mode the rate follows AIMD: the engines report each probe's
+// outcome, and every epoch the loss fraction (timeouts and ICMP errors) is
+// compared with its running baseline. A spike above the baseline halves
+// the rate; otherwise it grows by a fixed step, up to the configured rate.
+// Outcomes lag the sends by up to the probe timeout, so after a cut the
+// rate is not cut again until that long has passed.
+class RateLimiter {
+public:
+    // Starting rate in adaptive mode when no --rate ceiling is given
+    static constexpr double DEFAULT_ADAPTIVE_RATE = 10000.0;
+    
+    // nullptr when the config asks for neither a rate nor adaptive mode
+    static std::unique_ptr<RateLimiter> from_config(const ScanConfig& config);
+    
+    // rate in probes/s; 0 with adaptive means start at DEFAULT_ADAPTIVE_RATE, uncapped.
+    // feedback_delay is how late a probe's outcome can be reported
+    RateLimiter(double rate, bool adaptive, Duration feedback_delay = Duration{0});
+    
+    // Take up to wanted tokens without blocking; returns how many were granted
+    std::size_t try_acquire(std::size_t wanted = 1);
+    
+    // Sleep until one token is granted; false if cancelled first
+    bool acquire(const std::atomic<bool>& cancelled);
+    
+    // Time until the next token is available (zero if one is available now)
+    std::chrono::nanoseconds delay();
+    
+    // Probe outcomes for adaptive mode: an answer (any port state), or a
+    // timeout/ICMP error. Lock-free; safe from any thread
+    void on_reply() { replies_.fetch_add(1, std::memory_order_relaxed); }
+    void on_loss() { losses_.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    std::mutex mutex_;
+    double rate_;
+    double ceiling_;                // 0 = no upper bound
+    double step_;                   // additive increase per epoch
+    double tokens_;
+    bool adaptive_;
+    Clock::time_point last_refill_;
+    
+    // Adaptive state
+    std::atomic<std::size_t> replies_{0};
+    std::atomic<std::size_t> losses_{0};
+    Clock::time_point epoch_start_;
+    Clock::time_point last_decrease_;
+    Duration feedback_delay_;
+    double baseline_loss_ = -1.0;   // < 0 until the first epoch closes
+    
+    double burst() const;
+    void refill(Clock::time_point now);
+    void adapt(Clock::time_point now);
+};
+
+} // namespace PortScanner
\ No newline at end of file
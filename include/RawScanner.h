@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Common.h"
+#include "ScanResults.h"
+#include "ProbeCookie.h"
+#include "PacketRing.h"
+#include "ProbeTemplate.h"
+#include "RateLimiter.h"
+#include "RttEstimator.h"
+#include "ScanTargets.h"
+#include "ResultSink.h"
+#include <netinet/in.h>
+#include <functional>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+namespace PortScanner {
+
+// TCP probe scanner on raw sockets, shared by the SYN, ACK, FIN, NULL and
+// Xmas scans: a transmit thread sends a crafted probe per port while a
+// receive thread matches the SYN-ACK/RST and ICMP unreachable replies back
+// to them. Requires root (CAP_NET_RAW).
+//
+//   SYN:           SYN-ACK open, RST closed, ICMP/silence filtered
+//   ACK:           RST unfiltered, ICMP/silence filtered
+//   FIN/NULL/Xmas: RST closed, ICMP filtered, silence open|filtered
+//
+// Each probe's sequence number and source port come from a keyed cookie, so
+// a reply is validated from its own headers. In stateless mode no per-probe
+// record is kept at all: three bits per probe (replied, reset, unreachable)
+// are the only state, whatever the number of probes in flight.
+//
+// Probes to several targets interleave hosts (see ProbeSpace) and leave
+// from the source address of the first target's route. Each target has its
+// own RTT estimate, so replies from a near host never cut short the wait
+// for a far one.
+//
+// Probes are patched from a per-scan template and go out through a
+// PACKET_TX_RING when possible (single-target scans: the ring writes frames
+// to one next hop). Replies are read from a TPACKET_V3 ring when
+// possible. Either side falls back to a raw socket. With --rate the
+// transmit thread paces itself; in adaptive mode ICMP unreachables count
+// as losses and TCP answers as replies.
+class RawScanner {
+public:
+    using ProgressCallback = std::function<void(std::size_t completed, std::size_t total)>;
+    
+    // Throws std::runtime_error if raw sockets cannot be opened
+    explicit RawScanner(const ScanConfig& config);
+    ~RawScanner();
+    
+    RawScanner(const RawScanner&) = delete;
+    RawScanner& operator=(const RawScanner&) = delete;
+    
+    ScanResults scan(ProgressCallback progress_cb = nullptr);
+    void cancel();
+    
+    // Hand each final result to this sink: answers as they come in, timeouts
+    // once the scan is over (null: none)
+    void set_sink(ResultSink* sink) { sink_ = sink; }
+    
+    // Counters of the last scan
+    const PacketStats& stats() const noexcept { return stats_; }
+
+private:
+    // Send/reply timestamps, only kept outside stateless mode
+    struct Probe {
+        std::atomic<std::int64_t> sent_ns{0};
+        std::atomic<std::int64_t> reply_ns{0};
+    };
+    
+    using Bitmap = std::unique_ptr<std::atomic<std::uint64_t>[]>;
+    
+    ScanConfig config_;
+    int send_fd_ = -1;
+    int recv_fd_ = -1;
+    int icmp_fd_ = -1;
+    std::unique_ptr<PacketRing> ring_;
+    std::unique_ptr<PacketTxRing> tx_ring_;
+    std::unique_ptr<ProbeTemplate> template_;
+    std::unique_ptr<RateLimiter> limiter_;   // null when the rate is unlimited
+    std::deque<RttEstimator> rtt_;           // per target; bounds the wait after its last probe
+    HostTable hosts_;
+    ProbeSpace space_;                       // probe index -> (host, port)
+    in_addr_t source_ip_ = 0;
+    std::uint8_t probe_flags_ = 0;
+    std::uint32_t sequence_space_ = 0;       // sequence numbers our probe consumes
+    ProbeCookie cookie_;
+    ResultSink* sink_ = nullptr;
+    
+    std::unique_ptr<Probe[]> probes_;
+    Bitmap replied_;                         // drops duplicate and retransmitted replies
+    Bitmap reset_;                           // answered with RST
+    Bitmap unreachable_;                     // answered with ICMP unreachable
+    
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> tx_done_{false};
+    std::unique_ptr<std::atomic<std::int64_t>[]> last_send_ns_;  // per target: its last probe; 0 if none
+    std::atomic<std::size_t> answered_{0};
+    std::atomic<std::size_t> sent_{0};
+    PacketStats stats_;
+    
+    void transmit_loop();
+    void receive_loop(const ProgressCallback& progress_cb);
+    void receive_from_socket(const ProgressCallback& progress_cb);
+    bool handle_reply(const std::uint8_t* packet, std::size_t length);
+    bool handle_tcp_reply(const std::uint8_t* packet, std::size_t length);
+    bool handle_icmp_reply(const std::uint8_t* packet, std::size_t length);
+    bool record_reply(std::int64_t index, const Bitmap* outcome);
+    PortStatus reply_status(std::size_t index) const;
+    PortStatus unanswered_status() const;
+    std::int64_t receive_deadline() const;
+    ScanResults collect_results();
+    
+    static std::uint8_t probe_flags(ScanType scan_type);
+    static Bitmap make_bitmap(std::size_t bits);
+    static bool test_and_set(const Bitmap& bitmap, std::size_t index);
+    static bool test(const Bitmap& bitmap, std::size_t index);
+    static std::int64_t now_ns();
+};
+
+} // namespace PortScanner
\ No newline at end of file
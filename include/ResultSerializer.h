@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Common.h"
+#include "ScanResults.h"
+#include <ostream>
+#include <string_view>
+
+namespace PortScanner {
+
+// Writes results as txt, json, xml or ndjson. Rows are formatted straight
+// from the ScanResults columns into large string buffers that are reused
+// from chunk to chunk, with std::to_chars for numbers and escaping that
+// scans 16 bytes at a time for the characters a format must escape (quotes,
+// backslashes and control characters in JSON; markup characters in XML).
+//
+// Rows are split into chunks of CHUNK_ROWS. Several threads format one
+// chunk each into their own buffers while the previous round is written
+// out, so rounds come out in row order and the file is the same whatever
+// the thread count; memory stays at two buffers per thread.
+class ResultSerializer {
+public:
+    static constexpr std::size_t CHUNK_ROWS = 64 * 1024;
+    
+    // format is one of txt, json, xml, ndjson (anything else: txt);
+    // threads = 0 picks one per online CPU
+    ResultSerializer(const ScanResults& results, const std::string& format, std::size_t threads = 0);
+    
+    // The whole file; returns false if out failed
+    bool write(std::ostream& out) const;
+    
+    // Rows [begin, end) of the file, in file order, appended to out; the
+    // texts of consecutive ranges concatenate to that of the whole
+    void append_rows(std::string& out, std::size_t begin, std::size_t end) const;
+    
+    // One NDJSON line for result, newline included (the --stream format).
+    // With detail, the line also carries whatever service version, product,
+    // extra info, confidence and banner the result has (checkpoints keep them)
+    static void append_ndjson(std::string& out, const ScanResult& result, bool detail = false);
+    
+    // text as a quoted JSON string, and as XML character data
+    static void append_json_string(std::string& out, std::string_view text);
+    static void append_xml_text(std::string& out, std::string_view text);
+    
+    static void append_number(std::string& out, long long value);
+    static void append_float(std::string& out, float value);
+    
+    // Position of the first byte of text that JSON (xml = false) or XML
+    // must escape, or length. These are the kernels this CPU can run, scalar
+    // first and the one the serializer uses last; for tests and benchmarks
+    using FindKernel = std::size_t (*)(const char* text, std::size_t length);
+    static std::vector<std::pair<std::string, FindKernel>> escape_kernels(bool xml);
+
+private:
+    enum class Format { TXT, JSON, XML, NDJSON };
+    
+    const ScanResults& results_;
+    Format format_;
+    std::size_t threads_;
+    const std::vector<std::uint32_t>* order_ = nullptr;  // row order of a txt report; null: insertion order
+    bool with_host_ = false;                              // txt reports add a HOST column for several hosts
+    
+    void append_header(std::string& out) const;
+    void append_footer(std::string& out) const;
+    void append_row(std::string& out, std::size_t index, bool last) const;
+    
+    // detail: the result whose service detail and banner to add, if any
+    static void append_ndjson_row(std::string& out, std::string_view host, Port port, PortStatus status,
+                                  std::string_view service, long long response_ms,
+                                  const ScanResult* detail = nullptr);
+};
+
+} // namespace PortScanner
\ No newline at end of file
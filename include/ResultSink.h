@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Common.h"
+#include "ScanTargets.h"
+#include <vector>
+
+namespace PortScanner {
+
+// Where engines hand each final result as it comes in: the checkpoint, the
+// --stream output, or both. Engines call record() from their own threads,
+// once per probe and only for outcomes no later pass or cancel can change,
+// so implementations must be thread-safe and must not block for long.
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+    
+    virtual void record(const ProbeTarget& probe, const ScanResult& result) = 0;
+};
+
+// Passes each result on to every sink added, in order
+class ResultSinks : public ResultSink {
+public:
+    void add(ResultSink* sink) { sinks_.push_back(sink); }
+    void clear() { sinks_.clear(); }
+    bool empty() const noexcept { return sinks_.empty(); }
+    
+    void record(const ProbeTarget& probe, const ScanResult& result) override {
+        for (ResultSink* sink : sinks_) {
+            sink->record(probe, result);
+        }
+    }
+
+private:
+    std::vector<ResultSink*> sinks_;
+};
+
+} // namespace PortScanner
\ No newline at end of file
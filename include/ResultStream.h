@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Common.h"
+#include "ResultSink.h"
+#include "ScanResults.h"
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace PortScanner {
+
+// --stream output: one JSON object per line (NDJSON), written while the
+// scan runs, so a consumer tailing the file sees results within a second of
+// their arrival and a long scan never holds its whole output in memory.
+//
+// record() formats the line into a pending buffer under a short lock; a
+// background thread swaps the buffer out and writes it whenever it passes
+// FLUSH_BYTES or FLUSH_INTERVAL has gone by, so engines never wait on the
+// disk. Each probe's final outcome is written exactly once.
+class ResultStream : public ResultSink {
+public:
+    static constexpr std::size_t FLUSH_BYTES = 64 * 1024;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{1000};
+    
+    // Truncates filename; throws std::runtime_error if it cannot be opened
+    explicit ResultStream(const std::string& filename);
+    ~ResultStream() override;
+    
+    ResultStream(const ResultStream&) = delete;
+    ResultStream& operator=(const ResultStream&) = delete;
+    
+    // Thread-safe; UNKNOWN is a probe that failed, and is written like any other outcome
+    void record(const ProbeTarget& probe, const ScanResult& result) override;
+    
+    // Results that were not probed in this run, e.g. those of a resumed checkpoint
+    void write(const ScanResults& results);
+    
+    // Write out everything pending and stop the writer; returns false if
+    // any write failed. Idempotent.
+    bool close();
+    
+    std::size_t lines() const;
+
+private:
+    std::ofstream file_;
+    
+    mutable std::mutex mutex_;              // guards pending_, lines_, stopping_ and failed_
+    std::string pending_;                   // formatted lines not yet handed to the writer
+    std::size_t lines_ = 0;
+    bool stopping_ = false;
+    bool failed_ = false;
+    std::condition_variable wake_;
+    
+    std::thread writer_;
+    
+    void append(const ScanResult& result);
+    void write_loop();
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Common.h"
+#include "ScanResults.h"
+#include <ostream>
+#include <string_view>
+
+namespace PortScanner {
+
+// Binary results file (-f bin), read in place through mmap. Little more
+// than ScanResults' own columns on disk:
+//
+//   header     magic, version, byte order mark, row count, per-status counts
+//              and the offset and length of every section below
+//   columns    host id (u32), port (u16), status (u8), response ms (i32),
+//              service id (u32) and banner id (u32), one entry per result
+//   strings    dictionary shared by hosts, services and banners: n+1 u64
+//              offsets into a blob of UTF-8 bytes
+//
+// Sections start 8-byte aligned, so a column is used straight from the
+// mapping; nothing is parsed or copied until a row is asked for. The header
+// counts cover every result of the scan, also those a --stream scan only
+// counted. Files are written in the host's byte order and a reader on the
+// other order rejects them.
+class ResultsFile {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint32_t NO_STRING = 0xffffffff;
+    
+    // Maps filename and checks its header and section bounds; throws
+    // std::runtime_error if it cannot be read or is not a results file
+    explicit ResultsFile(const std::string& filename);
+    ~ResultsFile();
+    
+    ResultsFile(const ResultsFile&) = delete;
+    ResultsFile& operator=(const ResultsFile&) = delete;
+    
+    // Does filename start with the magic? (false if it cannot be opened)
+    static bool is_results_file(const std::string& filename);
+    
+    // Write results in this format
+    static void write(const ScanResults& results, std::ostream& out);
+    
+    std::size_t size() const noexcept { return rows_; }
+    std::size_t count(PortStatus status) const noexcept;
+    std::size_t total_count() const noexcept;
+    
+    // Row i, column by column, without assembling it
+    Port port(std::size_t index) const { return ports_[index]; }
+    PortStatus status(std::size_t index) const;
+    std::int32_t response_ms(std::size_t index) const { return response_ms_[index]; }
+    std::string_view host(std::size_t index) const { return string(hosts_[index]); }
+    std::string_view service(std::size_t index) const { return string(services_[index]); }
+    std::string_view banner(std::size_t index) const { return string(banners_[index]); }
+    
+    // Dictionary entry id; empty for NO_STRING or an id out of range
+    std::string_view string(std::uint32_t id) const;
+    
+    ScanResult at(std::size_t index) const;
+    
+    // Everything, as in-memory results (counts included)
+    ScanResults to_results() const;
+
+private:
+    enum Section { HOSTS, PORTS, STATUSES, RESPONSE_MS, SERVICES, BANNERS, STRING_OFFSETS, STRING_DATA, SECTION_COUNT };
+    
+    struct SectionEntry {
+        std::uint64_t offset;
+        std::uint64_t bytes;
+    };
+    
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;               // BYTE_ORDER_MARK as the writer stored it
+        std::uint64_t rows;
+        std::uint64_t status_counts[6];         // by PortStatus value
+        std::uint64_t strings;
+        SectionEntry sections[SECTION_COUNT];
+    };
+    
+    static constexpr char MAGIC[8] = {'P', 'S', 'C', 'A', 'N', 'R', 'E', 'S'};
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    
+    void* mapping_ = nullptr;
+    std::size_t mapping_size_ = 0;
+    const Header* header_ = nullptr;
+    std::size_t rows_ = 0;
+    std::size_t strings_ = 0;
+    
+    // Columns and dictionary, pointing into the mapping
+    const std::uint32_t* hosts_ = nullptr;
+    const Port* ports_ = nullptr;
+    const std::uint8_t* statuses_ = nullptr;
+    const std::int32_t* response_ms_ = nullptr;
+    const std::uint32_t* services_ = nullptr;
+    const std::uint32_t* banners_ = nullptr;
+    const std::uint64_t* string_offsets_ = nullptr;
+    const char* string_data_ = nullptr;
+    
+    // Start of section, after checking it lies in the file with the size expected
+    const void* section(Section section, std::uint64_t bytes, const std::string& filename) const;
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Common.h"
+#include <atomic>
+#include <mutex>
+
+namespace PortScanner {
+
+// Jacobson/Karels round-trip estimator for one target (RFC 6298 rules).
+// Answered probes feed in their RTT; the probe timeout derived from it,
+// SRTT + 4 * RTTVAR clamped to [min, max], bounds how long the probes sent
+// from then on wait for an answer. Until the first sample the configured
+// timeout applies.
+class RttEstimator {
+public:
+    // Bounds from --min-rtt-timeout/--max-rtt-timeout, starting at --timeout
+    explicit RttEstimator(const ScanConfig& config);
+    RttEstimator(Duration initial, Duration min_timeout, Duration max_timeout);
+    
+    // Thread-safe; samples from every sender of the scan may arrive at once
+    void add_sample(std::chrono::nanoseconds rtt);
+    
+    // Current probe timeout; lock-free
+    std::chrono::nanoseconds timeout() const {
+        return std::chrono::nanoseconds(timeout_ns_.load(std::memory_order_relaxed));
+    }
+    Duration timeout_ms() const {
+        return std::chrono::ceil<Duration>(timeout());
+    }
+
+private:
+    std::mutex mutex_;
+    double srtt_ns_ = 0.0;
+    double rttvar_ns_ = 0.0;
+    bool has_sample_ = false;
+    std::int64_t min_ns_;
+    std::int64_t max_ns_;
+    std::atomic<std::int64_t> timeout_ns_;
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -3,40 +3,184 @@
 #include "Common.h"
 #include <iostream>
 #include <fstream>
+#include <array>
+#include <iterator>
+#include <limits>
 
 namespace PortScanner {
 
+// Results of a scan, stored column-wise: port, status, response time and
+// host index are packed arrays (15 bytes a result), hosts and service names
+// are interned, and service details and banners live in a side table that
+// only results carrying them (open ports, in practice) have an entry in.
+// A closed or filtered port costs no string at all.
+//
+// ScanResult rows go in through add_result() and are assembled again only
+// when read through get_results(), one at a time. add_result() also keeps
+// per-status counts and an index of the open ports, so summaries are O(1)
+// and never walk the columns; the host/port order of the detailed report is
+// built on first use and kept until the results change.
+//
+// A --stream scan keeps rows only for some statuses (see for_config()); the
+// rest are counted but not stored, so totals and counts still cover every
+// result while get_results() yields just the rows kept.
 class ScanResults {
 public:
+    // Input iterator over the results in insertion order; yields rows by value
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ScanResult;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ScanResult*;
+        using reference = ScanResult;
+        
+        const_iterator() = default;
+        
+        ScanResult operator*() const { return results_->at(index_); }
+        const_iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+    
+    private:
+        friend class ScanResults;
+        const ScanResults* results_ = nullptr;
+        std::size_t index_ = 0;
+        
+        const_iterator(const ScanResults* results, std::size_t index) : results_(results), index_(index) {}
+    };
+    
+    // Read-only view of every result; valid while the ScanResults is unchanged
+    class View {
+    public:
+        const_iterator begin() const { return const_iterator(results_, 0); }
+        const_iterator end() const { return const_iterator(results_, results_->ports_.size()); }
+        std::size_t size() const noexcept { return results_->ports_.size(); }
+        bool empty() const noexcept { return size() == 0; }
+        ScanResult operator[](std::size_t index) const { return results_->at(index); }
+        ScanResult front() const { return results_->at(0); }
+    
+    private:
+        friend class ScanResults;
+        const ScanResults* results_;
+        
+        explicit View(const ScanResults* results) : results_(results) {}
+    };
+    
     ScanResults() = default;
     
+    // Empty results for an engine running this config: everything is kept,
+    // except in a --stream scan, where the stream has every row and memory
+    // holds only the open ports (and, with retries, the filtered ones the
+    // next pass re-probes)
+    static ScanResults for_config(const ScanConfig& config);
+    
     void add_result(const ScanResult& result);
-    void add_result(Port port, PortStatus status, Duration response_time = Duration{0}, 
+    void add_result(Port port, PortStatus status, Duration response_time = Duration{0},
                    const std::string& service = "");
     
-    std::size_t total_count() const noexcept { return results_.size(); }
-    std::size_t open_count() const noexcept;
-    std::size_t closed_count() const noexcept;
-    std::size_t filtered_count() const noexcept;
+    // Append another result set (e.g. from a per-thread scanner)
+    void merge(ScanResults&& other);
     
-    const std::vector<ScanResult>& get_results() const noexcept { return results_; }
+    // Remove the results with this status and return them (to re-probe their ports)
+    std::vector<ScanResult> extract(PortStatus status);
+    
+    // Every result added, whether or not its row was kept
+    std::size_t total_count() const noexcept;
+    std::size_t open_count() const noexcept { return count_status(PortStatus::OPEN); }
+    std::size_t closed_count() const noexcept { return count_status(PortStatus::CLOSED); }
+    std::size_t filtered_count() const noexcept { return count_status(PortStatus::FILTERED); }
+    std::size_t open_filtered_count() const noexcept { return count_status(PortStatus::OPEN_FILTERED); }
+    std::size_t unfiltered_count() const noexcept { return count_status(PortStatus::UNFILTERED); }
+    
+    View get_results() const noexcept { return View(this); }
     std::vector<ScanResult> get_open_ports() const;
     
+    // Result i, assembled from the columns
+    ScanResult at(std::size_t index) const;
+    
+    // Single columns of result i, without assembling the row
+    Port port(std::size_t index) const { return ports_[index]; }
+    PortStatus status(std::size_t index) const { return statuses_[index]; }
+    const IPAddress& host(std::size_t index) const { return host_names_[hosts_[index]]; }
+    
     void print_summary(std::ostream& os = std::cout) const;
     void print_detailed(std::ostream& os = std::cout) const;
     
     bool save_to_file(const std::string& filename, const std::string& format = "txt") const;
     
-    void clear() { results_.clear(); }
+    // Read back a JSON, NDJSON, XML or binary file written by save_to_file
+    // or a --stream scan (e.g. one shard's output)
+    static ScanResults load_from_file(const std::string& filename);
+    
+    static std::string status_to_string(PortStatus status);
+    
+    void clear();
 
 private:
-    std::vector<ScanResult> results_;
+    friend class ResultsFile;       // writes and reloads the columns as they are
+    friend class ResultSerializer;  // formats straight from the columns
+    
+    static constexpr std::uint32_t NO_DETAIL = std::numeric_limits<std::uint32_t>::max();
+    
+    // What only some results have: everything in ServiceInfo but the name
+    // (interned), and the banner
+    struct Detail {
+        std::uint32_t service = 0;          // index into service_names_
+        std::string version;
+        std::string product;
+        std::string extra_info;
+        float confidence = 0.0f;
+        std::string banner;
+    };
+    
+    // One entry per result
+    std::vector<Port> ports_;
+    std::vector<PortStatus> statuses_;
+    std::vector<std::int32_t> response_ms_;
+    std::vector<std::uint32_t> hosts_;      // index into host_names_
+    std::vector<std::uint32_t> details_;    // index into detail_table_, NO_DETAIL if none
+    
+    // Interned values and the side table
+    std::vector<IPAddress> host_names_;
+    std::vector<IPVersion> host_versions_;
+    std::unordered_map<IPAddress, std::uint32_t> host_index_;
+    std::vector<std::string> service_names_;
+    std::unordered_map<std::string, std::uint32_t> service_index_;
+    std::vector<Detail> detail_table_;
+    
+    // Kept up to date by every change
+    std::array<std::size_t, 6> status_counts_{};   // by PortStatus value
+    std::vector<std::uint32_t> open_indices_;      // results that are OPEN, in insertion order
+    std::uint8_t kept_statuses_ = 0xff;            // bit per PortStatus value; others are only counted
+    
+    // Built on first use, dropped by every change
+    mutable std::vector<std::uint32_t> sorted_;    // every result, by host address then port
+    mutable bool sorted_valid_ = false;
+    
+    std::uint32_t intern_host(const IPAddress& host, IPVersion ip_version);
+    std::uint32_t intern_service(const std::string& name);
+    std::size_t count_status(PortStatus status) const noexcept {
+        return status_counts_[static_cast<std::size_t>(status)];
+    }
+    bool keeps(PortStatus status) const noexcept {
+        return (kept_statuses_ >> static_cast<unsigned>(status)) & 1;
+    }
+    
+    const std::string& service_name(std::size_t index) const;
     
-    void save_as_txt(std::ofstream& file) const;
-    void save_as_json(std::ofstream& file) const;
-    void save_as_xml(std::ofstream& file) const;
+    // Each host's place in address order, and result indices sorted by it
+    std::vector<std::uint32_t> host_ranks() const;
+    void sort_by_host_and_port(std::vector<std::uint32_t>& indices) const;
+    const std::vector<std::uint32_t>& sorted_view() const;
     
-    std::string status_to_string(PortStatus status) const;
+    // Tables get a HOST column once a scan covers more than one host
+    bool has_multiple_hosts() const;
+    void print_row(std::ostream& os, std::size_t index, bool with_host) const;
+    void print_header(std::ostream& os, bool with_host) const;
 };
 
 } // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Common.h"
+#include <netinet/in.h>
+#include <array>
+#include <unordered_map>
+#include <utility>
+
+namespace PortScanner {
+
+// One (host, port) pair to probe; host indexes ScanConfig::targets
+struct ProbeTarget {
+    std::uint32_t host = 0;
+    Port port = 0;
+};
+
+// Keyed bijection on [0, size): a balanced Feistel network over the
+// smallest even number of bits that covers size, cycle-walked back into
+// range. Any index maps in O(1) expected time (fewer than four walks on
+// average) and nothing is stored, so an ordering can be split between
+// workers or resumed at any index. Default-constructed, it is the identity.
+class ProbePermutation {
+public:
+    ProbePermutation() = default;
+    ProbePermutation(std::uint64_t size, std::uint64_t seed);
+    
+    std::uint64_t operator()(std::uint64_t index) const;
+    std::uint64_t inverse(std::uint64_t value) const;
+
+private:
+    static constexpr int ROUNDS = 4;
+    
+    std::uint64_t size_ = 0;
+    unsigned half_bits_ = 0;
+    std::uint64_t half_mask_ = 0;
+    std::array<std::uint64_t, ROUNDS> keys_{};
+    bool keyed_ = false;
+    
+    std::uint64_t encrypt(std::uint64_t value) const;
+    std::uint64_t decrypt(std::uint64_t value) const;
+};
+
+// The (host, port) pairs of one scan pass. A full pass covers every target
+// on every port. Pair j is target j % hosts on port ports[j / hosts], and
+// probe i sends pair permutation(i): with --seed-keyed randomization the
+// scan visits hosts and ports in pseudo-random order, so no host or port
+// sees a burst; without it consecutive probes still alternate hosts.
+// Under --shard i/N a pass keeps every N-th position of that order, so
+// shards sharing a seed split the space evenly and never overlap. A
+// resumed scan keeps only the positions of its pending runs.
+// Those pairs are computed, never stored. Retry passes list their pairs
+// explicitly.
+class ProbeSpace {
+public:
+    ProbeSpace() = default;
+    
+    // Full pass over config.targets x config.ports, in config.seed order
+    explicit ProbeSpace(const ScanConfig& config);
+    explicit ProbeSpace(std::vector<ProbeTarget> probes);
+    
+    // Retry pass over the (host, port) pairs of these results
+    static ProbeSpace from_results(const std::vector<ScanResult>& results, const std::vector<IPAddress>& targets);
+    
+    std::size_t size() const noexcept { return size_; }
+    
+    ProbeTarget operator[](std::size_t index) const {
+        if (!probes_.empty()) return probes_[index];
+        
+        const std::uint64_t position = runs_.empty() ? index : pending_position(index);
+        const std::uint64_t pair = permutation_(position * shard_count_ + shard_index_);
+        return ProbeTarget{static_cast<std::uint32_t>(pair % host_count_), ports_[pair / host_count_]};
+    }
+    
+    // Index of a pair in a full pass; -1 if the pass (or shard) does not probe it
+    std::int64_t index_of(std::uint32_t host, Port port) const;
+
+private:
+    std::size_t host_count_ = 0;
+    PortSet port_set_;
+    std::vector<Port> ports_;                // port_set_ in ascending order
+    std::vector<std::uint32_t> port_rank_;   // ports_ position of each bitmap word's first port
+    std::vector<ProbeTarget> probes_;        // explicit pairs (retry passes)
+    ProbePermutation permutation_;
+    std::size_t shard_index_ = 0;
+    std::size_t shard_count_ = 1;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> runs_;  // pending positions (resumed scans)
+    std::vector<std::uint64_t> run_offsets_;                     // index of each run's first position
+    std::size_t size_ = 0;
+    
+    std::uint64_t pending_position(std::uint64_t index) const;
+};
+
+// Probes in a full pass: every target on every port, or this shard's share,
+// or what is left of it in a resumed scan
+std::size_t probe_count(const ScanConfig& config);
+
+// IPv4 targets in network byte order, with the reverse lookup that matches
+// a reply's address back to its target
+class HostTable {
+public:
+    explicit HostTable(const std::vector<IPAddress>& targets);
+    
+    std::size_t size() const noexcept { return addresses_.size(); }
+    in_addr_t operator[](std::uint32_t host) const { return addresses_[host]; }
+    
+    // Index of the target with this address, -1 if it is not one
+    std::int64_t find(in_addr_t address) const;
+    
+    // Smallest network (address, mask; network order) holding every target
+    std::pair<in_addr_t, in_addr_t> enclosing_prefix() const;
+
+private:
+    std::vector<in_addr_t> addresses_;
+    std::unordered_map<in_addr_t, std::uint32_t> index_;
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Common.h"
+#include <array>
+
+namespace PortScanner {
+
+// Hierarchical timer wheel with millisecond ticks.
+// Timers are identified by a dense integer id (e.g. a connection slot), so
+// schedule, cancel and expiry are all O(1) with no allocation on the hot path.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = std::size_t;
+    
+    explicit TimerWheel(std::size_t capacity = 0);
+    
+    // Drop all timers and make room for ids [0, capacity)
+    void reset(std::size_t capacity);
+    
+    void schedule(TimerId id, Clock::time_point deadline);
+    void cancel(TimerId id);
+    
+    // Collect every timer whose deadline is at or before now
+    void advance(Clock::time_point now, std::vector<TimerId>& expired);
+    
+    // Milliseconds until the nearest deadline (-1 when no timer is armed)
+    int next_timeout_ms(Clock::time_point now) const;
+    
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+private:
+    static constexpr std::size_t LEVELS = 4;
+    static constexpr std::size_t SLOT_BITS = 6;
+    static constexpr std::size_t SLOTS = std::size_t{1} << SLOT_BITS;
+    static constexpr TimerId NIL = static_cast<TimerId>(-1);
+    
+    struct Node {
+        std::uint64_t expires = 0;
+        TimerId prev = NIL;
+        TimerId next = NIL;
+        std::uint8_t level = 0;
+        std::uint8_t slot = 0;
+        bool armed = false;
+    };
+    
+    Clock::time_point origin_;
+    std::uint64_t current_ = 0;
+    std::size_t size_ = 0;
+    std::vector<Node> nodes_;
+    std::array<std::array<TimerId, SLOTS>, LEVELS> heads_;
+    std::array<std::uint64_t, LEVELS> occupied_{};
+    
+    std::uint64_t to_tick(Clock::time_point tp, bool round_up) const;
+    void link(TimerId id);
+    void unlink(TimerId id);
+    void cascade(std::size_t level);
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Common.h"
+#include "ScanResults.h"
+#include "RateLimiter.h"
+#include "RttEstimator.h"
+#include "ScanTargets.h"
+#include "ResultSink.h"
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <functional>
+#include <atomic>
+#include <deque>
+
+namespace PortScanner {
+
+// Batched UDP scanner: probes are fanned out over a few unconnected sockets
+// with sendmmsg and replies are collected in bulk with recvmmsg. ICMP
+// errors arrive on each socket's error queue (IP_RECVERR), so no raw
+// socket is needed. A datagram reply means OPEN, port unreachable means
+// CLOSED, other unreachables mean FILTERED and silence is OPEN_FILTERED.
+// Probes to several targets interleave hosts (see ProbeSpace), and each
+// target has its own RTT estimate for its probes' timeout. With --rate
+// each batch is trimmed to the tokens available.
+class UdpScanner {
+public:
+    using ProgressCallback = std::function<void(std::size_t completed, std::size_t total)>;
+    
+    // Throws std::runtime_error if the sockets cannot be created
+    explicit UdpScanner(const ScanConfig& config);
+    ~UdpScanner();
+    
+    UdpScanner(const UdpScanner&) = delete;
+    UdpScanner& operator=(const UdpScanner&) = delete;
+    
+    ScanResults scan(ProgressCallback progress_cb = nullptr);
+    void cancel();
+    
+    // Hand each final result to this sink: answers as they come in, timeouts
+    // once the scan is over (null: none)
+    void set_sink(ResultSink* sink) { sink_ = sink; }
+
+private:
+    static constexpr std::size_t SOCKET_COUNT = 4;
+    static constexpr std::size_t BATCH_SIZE = 64;
+    
+    struct Probe {
+        std::int64_t sent_ns = 0;
+        std::int64_t reply_ns = 0;
+        PortStatus status = PortStatus::OPEN_FILTERED;
+    };
+    
+    // Per-socket send cursor and the probes it owns (every SOCKET_COUNT-th one)
+    struct Lane {
+        int fd = -1;
+        std::size_t next = 0;
+    };
+    
+    ScanConfig config_;
+    HostTable hosts_;
+    ProbeSpace space_;                       // probe index -> (host, port)
+    Lane lanes_[SOCKET_COUNT];
+    
+    std::vector<Probe> probes_;
+    std::size_t answered_ = 0;
+    std::unique_ptr<RateLimiter> limiter_;   // null when the rate is unlimited
+    std::size_t rate_credit_ = 0;            // tokens taken but not yet spent on a send
+    std::deque<RttEstimator> rtt_;           // per target; bounds the wait after its last probe
+    std::vector<std::int64_t> last_send_ns_; // per target: its last probe; 0 if none
+    std::atomic<bool> cancelled_{false};
+    ResultSink* sink_ = nullptr;
+    
+    std::size_t send_batch(Lane& lane);
+    void drain_replies(int fd);
+    void drain_errors(int fd);
+    void record(in_addr_t address, Port port, PortStatus status);
+    ScanResults collect_results();
+    std::int64_t receive_deadline() const;
+    
+    static std::int64_t now_ns();
+};
+
+} // namespace PortScanner
\ No newline at end of file
@@ -8,8 +8,51 @@
 
 namespace PortScanner {
 
+namespace {
+    // Long-only options
+    enum LongOption {
+        OPT_BACKEND = 256,
+        OPT_STATELESS,
+        OPT_RX_PATH,
+        OPT_TX_PATH,
+        OPT_RATE,
+        OPT_ADAPTIVE_RATE,
+        OPT_MIN_RTT_TIMEOUT,
+        OPT_MAX_RTT_TIMEOUT,
+        OPT_MAX_RETRIES,
+        OPT_RETRY_DELAY,
+        OPT_SEED,
+        OPT_NO_RANDOMIZE,
+        OPT_SHARD,
+        OPT_CHECKPOINT,
+        OPT_CHECKPOINT_INTERVAL,
+        OPT_RESUME,
+        OPT_DISCOVER,
+        OPT_PING_PORTS,
+        OPT_EXCLUDE_PORTS,
+        OPT_TOP_PORTS,
+        OPT_STREAM
+    };
+    
+    bool is_output_format(const std::string& format) {
+        return format == "txt" || format == "json" || format == "xml" || format == "ndjson" || format == "bin";
+    }
+}
+
 ArgumentsManager::ArgumentsManager(int argc, char* argv[]) {
     try {
+        // "PortScanner merge ..." combines shard outputs instead of scanning
+        if (argc > 1 && std::string(argv[1]) == "merge") {
+            parse_merge_arguments(argc - 1, argv + 1);
+            return;
+        }
+        
+        // "PortScanner convert ..." rewrites a results file in another format
+        if (argc > 1 && std::string(argv[1]) == "convert") {
+            parse_convert_arguments(argc - 1, argv + 1);
+            return;
+        }
+        
         parse_arguments(argc, argv);
         if (!should_exit_) {
             validate_config();
@@ -36,14 +79,39 @@ void ArgumentsManager::parse_arguments(int argc, char* argv[]) {
         {"no-service-detection", no_argument, nullptr, 'S'},
         {"no-banner-grab", no_argument, nullptr, 'B'},
         {"performance", no_argument, nullptr, 'P'},
+        {"reactors", required_argument, nullptr, 'R'},
+        {"backend", required_argument, nullptr, OPT_BACKEND},
+        {"stateless", no_argument, nullptr, OPT_STATELESS},
+        {"rx-path", required_argument, nullptr, OPT_RX_PATH},
+        {"tx-path", required_argument, nullptr, OPT_TX_PATH},
+        {"rate", required_argument, nullptr, OPT_RATE},
+        {"adaptive-rate", no_argument, nullptr, OPT_ADAPTIVE_RATE},
+        {"min-rtt-timeout", required_argument, nullptr, OPT_MIN_RTT_TIMEOUT},
+        {"max-rtt-timeout", required_argument, nullptr, OPT_MAX_RTT_TIMEOUT},
+        {"max-retries", required_argument, nullptr, OPT_MAX_RETRIES},
+        {"retry-delay", required_argument, nullptr, OPT_RETRY_DELAY},
+        {"seed", required_argument, nullptr, OPT_SEED},
+        {"no-randomize", no_argument, nullptr, OPT_NO_RANDOMIZE},
+        {"shard", required_argument, nullptr, OPT_SHARD},
+        {"checkpoint", required_argument, nullptr, OPT_CHECKPOINT},
+        {"checkpoint-interval", required_argument, nullptr, OPT_CHECKPOINT_INTERVAL},
+        {"resume", required_argument, nullptr, OPT_RESUME},
+        {"discover", no_argument, nullptr, OPT_DISCOVER},
+        {"ping-ports", required_argument, nullptr, OPT_PING_PORTS},
+        {"exclude-ports", required_argument, nullptr, OPT_EXCLUDE_PORTS},
+        {"top-ports", required_argument, nullptr, OPT_TOP_PORTS},
+        {"stream", no_argument, nullptr, OPT_STREAM},
         {nullptr, 0, nullptr, 0}
     };
     
     // Initialize with defaults
     config_ = ConfigManager::create_default_config();
+    bool ports_given = false;
+    std::size_t top_ports = 0;
+    PortSet excluded;
     
     int opt;
-    while ((opt = getopt_long(argc, argv, "hVvt:p:T:j:s:6c:o:f:SBP", long_options, nullptr)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hVvt:p:T:j:s:6c:o:f:SBPR:", long_options, nullptr)) != -1) {
         switch (opt) {
             case 'h':
                 print_help();
@@ -64,7 +132,8 @@ void ArgumentsManager::parse_arguments(int argc, char* argv[]) {
                 break;
                 
             case 'p':
-                config_.ports = parse_port_range(optarg);
+                config_.ports = PortSet::parse(optarg);
+                ports_given = true;
                 break;
                 
             case 'T':
@@ -108,119 +177,401 @@ void ArgumentsManager::parse_arguments(int argc, char* argv[]) {
                 // Performance mode will be handled in main
                 break;
                 
+            case 'R':
+                config_.reactor_count = std::stoul(optarg);
+                break;
+                
+            case OPT_BACKEND: {
+                std::string backend = optarg;
+                if (backend != "epoll" && backend != "io_uring" && backend != "uring") {
+                    throw ArgumentError("Invalid backend. Supported: epoll, io_uring");
+                }
+                config_.async_backend = ConfigManager::string_to_backend(backend);
+                break;
+            }
+            
+            case OPT_STATELESS:
+                config_.stateless = true;
+                break;
+                
+            case OPT_RX_PATH: {
+                std::string path = optarg;
+                if (path != "ring" && path != "socket") {
+                    throw ArgumentError("Invalid receive path. Supported: ring, socket");
+                }
+                config_.rx_ring = path == "ring";
+                break;
+            }
+            
+            case OPT_TX_PATH: {
+                std::string path = optarg;
+                if (path != "ring" && path != "socket") {
+                    throw ArgumentError("Invalid send path. Supported: ring, socket");
+                }
+                config_.tx_ring = path == "ring";
+                break;
+            }
+            
+            case OPT_RATE:
+                config_.rate = std::stoul(optarg);
+                break;
+                
+            case OPT_ADAPTIVE_RATE:
+                config_.adaptive_rate = true;
+                break;
+                
+            case OPT_MIN_RTT_TIMEOUT:
+                config_.min_rtt_timeout = Duration{std::stoi(optarg)};
+                break;
+                
+            case OPT_MAX_RTT_TIMEOUT:
+                config_.max_rtt_timeout = Duration{std::stoi(optarg)};
+                break;
+                
+            case OPT_MAX_RETRIES:
+                config_.max_retries = std::stoul(optarg);
+                break;
+                
+            case OPT_RETRY_DELAY:
+                config_.retry_delay = Duration{std::stoi(optarg)};
+                break;
+                
+            case OPT_SEED:
+                config_.seed = std::stoull(optarg);
+                break;
+                
+            case OPT_NO_RANDOMIZE:
+                config_.randomize = false;
+                break;
+                
+            case OPT_SHARD: {
+                std::string shard = optarg;
+                const auto slash = shard.find('/');
+                if (slash == std::string::npos) {
+                    throw ArgumentError("Shard must be given as i/N, e.g. 1/4");
+                }
+                const std::size_t index = std::stoul(shard.substr(0, slash));
+                const std::size_t count = std::stoul(shard.substr(slash + 1));
+                if (count == 0 || index == 0 || index > count) {
+                    throw ArgumentError("Shard i/N must satisfy 1 <= i <= N");
+                }
+                config_.shard_index = index - 1;
+                config_.shard_count = count;
+                break;
+            }
+            
+            case OPT_CHECKPOINT:
+                config_.checkpoint_file = optarg;
+                break;
+                
+            case OPT_CHECKPOINT_INTERVAL:
+                config_.checkpoint_interval = std::chrono::seconds{std::stoi(optarg)};
+                break;
+                
+            case OPT_RESUME:
+                config_.resume_file = optarg;
+                break;
+                
+            case OPT_DISCOVER:
+                config_.discover = true;
+                break;
+                
+            case OPT_PING_PORTS:
+                config_.ping_ports = PortSet::parse(optarg).to_vector();
+                config_.discover = true;
+                break;
+                
+            case OPT_EXCLUDE_PORTS:
+                excluded |= PortSet::parse(optarg);
+                break;
+                
+            case OPT_TOP_PORTS:
+                top_ports = std::stoul(optarg);
+                if (top_ports == 0 || top_ports > PortSet::top_count()) {
+                    throw ArgumentError("Top ports must be between 1 and " + std::to_string(PortSet::top_count()));
+                }
+                break;
+                
+            case OPT_STREAM:
+                config_.stream = true;
+                break;
+                
             default:
                 throw ArgumentError("Invalid option");
         }
     }
     
-    // Handle positional arguments
+    // --top-ports replaces the default list or adds to an explicit -p;
+    // exclusions apply last, whichever order the options came in
+    if (top_ports > 0) {
+        PortSet ports = PortSet::top(top_ports);
+        if (ports_given) {
+            ports |= config_.ports;
+        }
+        config_.ports = std::move(ports);
+    }
+    config_.ports -= excluded;
+    
+    // Handle positional arguments; several targets join into one list
     if (optind < argc && config_.target == "127.0.0.1") {
         config_.target = argv[optind];
+        for (int i = optind + 1; i < argc; ++i) {
+            config_.target += ",";
+            config_.target += argv[i];
+        }
     }
 }
 
-void ArgumentsManager::validate_config() {
-    // Validate IP address or resolve hostname
-    if (!NetworkUtils::is_valid_ipv4(config_.target) && config_.ip_version != IPVersion::IPv6) {
-        try {
-            config_.target = NetworkUtils::resolve_hostname(config_.target);
-        } catch (const std::exception&) {
-            throw ArgumentError("Invalid IP address or hostname: " + config_.target);
+void ArgumentsManager::parse_merge_arguments(int argc, char* argv[]) {
+    const struct option long_options[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"verbose", no_argument, nullptr, 'v'},
+        {"output", required_argument, nullptr, 'o'},
+        {"format", required_argument, nullptr, 'f'},
+        {nullptr, 0, nullptr, 0}
+    };
+    
+    config_ = ConfigManager::create_default_config();
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "hvo:f:", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'h':
+                print_help();
+                should_exit_ = true;
+                return;
+                
+            case 'v':
+                config_.verbose = true;
+                break;
+                
+            case 'o':
+                config_.output_file = optarg;
+                break;
+                
+            case 'f':
+                config_.output_format = optarg;
+                break;
+                
+            default:
+                throw ArgumentError("Invalid merge option");
         }
     }
     
+    for (int i = optind; i < argc; ++i) {
+        config_.merge_files.push_back(argv[i]);
+    }
+    
+    if (config_.merge_files.empty()) {
+        throw ArgumentError("merge needs at least one results file");
+    }
+    
+    if (!is_output_format(config_.output_format)) {
+        throw ArgumentError("Invalid output format. Supported: txt, json, xml, ndjson, bin");
+    }
+}
+
+void ArgumentsManager::parse_convert_arguments(int argc, char* argv[]) {
+    const struct option long_options[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"output", required_argument, nullptr, 'o'},
+        {"format", required_argument, nullptr, 'f'},
+        {nullptr, 0, nullptr, 0}
+    };
+    
+    config_ = ConfigManager::create_default_config();
+    config_.output_format = "json";
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "ho:f:", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'h':
+                print_help();
+                should_exit_ = true;
+                return;
+                
+            case 'o':
+                config_.output_file = optarg;
+                break;
+                
+            case 'f':
+                config_.output_format = optarg;
+                break;
+                
+            default:
+                throw ArgumentError("Invalid convert option");
+        }
+    }
+    
+    if (optind + 1 != argc) {
+        throw ArgumentError("convert needs exactly one results file");
+    }
+    config_.convert_file = argv[optind];
+    
+    if (!is_output_format(config_.output_format)) {
+        throw ArgumentError("Invalid output format. Supported: txt, json, xml, ndjson, bin");
+    }
+}
+
+void ArgumentsManager::validate_config() {
+    // Expand CIDR blocks and ranges, resolve hostnames
+    try {
+        config_.targets = NetworkUtils::expand_targets(config_.target);
+    } catch (const std::exception& e) {
+        throw ArgumentError(e.what());
+    }
+    
     // Validate timeout
     if (config_.timeout.count() <= 0 || config_.timeout.count() > 60000) {
         throw ArgumentError("Timeout must be between 1 and 60000 milliseconds");
     }
     
+    // Validate RTT timeout bounds (a max of 0 means the timeout itself)
+    if (config_.min_rtt_timeout.count() <= 0 || config_.min_rtt_timeout.count() > 60000) {
+        throw ArgumentError("Minimum RTT timeout must be between 1 and 60000 milliseconds");
+    }
+    
+    if (config_.max_rtt_timeout.count() < 0 || config_.max_rtt_timeout.count() > 60000) {
+        throw ArgumentError("Maximum RTT timeout must be between 1 and 60000 milliseconds");
+    }
+    
     // Validate thread count
     if (config_.thread_count == 0 || config_.thread_count > 2000) {
         throw ArgumentError("Thread count must be between 1 and 2000");
     }
     
-    // Validate ports
+    // Validate the retry policy
+    if (config_.max_retries > 10) {
+        throw ArgumentError("Retries must be between 0 and 10");
+    }
+    
+    if (config_.retry_delay.count() < 0 || config_.retry_delay.count() > 60000) {
+        throw ArgumentError("Retry delay must be between 0 and 60000 milliseconds");
+    }
+    
+    // Validate the checkpoint period
+    if (config_.checkpoint_interval.count() <= 0 || config_.checkpoint_interval.count() > 86400) {
+        throw ArgumentError("Checkpoint interval must be between 1 and 86400 seconds");
+    }
+    
+    // Validate reactor count (0 selects one per online CPU)
+    if (config_.reactor_count > 1024) {
+        throw ArgumentError("Reactor count must be between 0 and 1024");
+    }
+    
+    // Validate probe rate (0 means unlimited)
+    if (config_.rate > 100000000) {
+        throw ArgumentError("Rate must be between 0 and 100000000 probes per second");
+    }
+    
+    // Validate ports; the port parser already rejected anything out of range
     if (config_.ports.empty()) {
         throw ArgumentError("No ports specified");
     }
     
-    for (Port port : config_.ports) {
-        if (port < MIN_PORT || port > MAX_PORT) {
-            throw ArgumentError("Port " + std::to_string(port) + " is out of valid range");
-        }
+    if (config_.ports.contains(0)) {
+        throw ArgumentError("Port 0 is out of valid range");
     }
     
     // Validate output format
-    if (config_.output_format != "txt" && config_.output_format != "json" && config_.output_format != "xml") {
-        throw ArgumentError("Invalid output format. Supported: txt, json, xml");
+    if (!is_output_format(config_.output_format)) {
+        throw ArgumentError("Invalid output format. Supported: txt, json, xml, ndjson, bin");
     }
-}
-
-std::vector<Port> ArgumentsManager::parse_port_range(const std::string& port_str) {
-    std::vector<Port> ports;
-    std::istringstream iss(port_str);
-    std::string token;
-    
-    while (std::getline(iss, token, ',')) {
-        // Remove whitespace
-        token.erase(std::remove_if(token.begin(), token.end(), ::isspace), token.end());
+    
+    // Results stream out one line each, as NDJSON
+    if (config_.stream && config_.output_format != "ndjson") {
+        throw ArgumentError("--stream writes NDJSON; use it with -f ndjson");
+    }
+    
+    // Shards only partition the space if they all walk the same order
+    if (config_.shard_count > 1) {
+        if (config_.randomize && config_.seed == 0) {
+            throw ArgumentError("--shard needs the same --seed on every shard (or --no-randomize)");
+        }
+        if (config_.shard_count > config_.targets.size() * config_.ports.size()) {
+            throw ArgumentError("More shards than (host, port) pairs to probe");
+        }
         
-        if (token.find('-') != std::string::npos) {
-            // Range format: start-end
-            std::size_t dash_pos = token.find('-');
-            Port start = std::stoi(token.substr(0, dash_pos));
-            Port end = std::stoi(token.substr(dash_pos + 1));
-            
-            if (start > end) {
-                std::swap(start, end);
-            }
-            
-            for (Port p = start; p <= end; ++p) {
-                ports.push_back(p);
-            }
-        } else {
-            // Single port
-            ports.push_back(std::stoi(token));
+        // Each shard would find its own live hosts and split a different list
+        if (config_.discover) {
+            throw ArgumentError("--discover cannot be combined with --shard: shards must share one target list");
         }
     }
     
-    // Remove duplicates and sort
-    std::sort(ports.begin(), ports.end());
-    ports.erase(std::unique(ports.begin(), ports.end()), ports.end());
-    
-    return ports;
+    if (config_.discover && config_.ping_ports.empty()) {
+        throw ArgumentError("No ping ports specified");
+    }
 }
 
 void ArgumentsManager::print_help() {
     std::cout << R"(PortScanner v2.1.0 - Advanced C++ Port Scanner
 
 USAGE:
-    PortScanner [OPTIONS] [TARGET]
+    PortScanner [OPTIONS] [TARGET...]
+    PortScanner merge [-o FILE] [-f FORMAT] [-v] RESULTS...
+    PortScanner convert [-o FILE] [-f FORMAT] RESULTS
 
 OPTIONS:
     -h, --help                  Show this help message
     -V, --version               Show version information
     -v, --verbose               Enable verbose output
-    -t, --target <IP>           Target IP address or hostname
-    -p, --ports <PORTS>         Port specification (e.g., 80,443,1000-2000)
-    -T, --timeout <MS>          Timeout in milliseconds (default: 3000)
+    -t, --target <TARGETS>      Targets: IPs, hostnames, CIDR blocks (10.0.0.0/24) and
+                                ranges (10.0.0.1-50, 10.0.0.1-10.0.1.9), comma-separated
+    -p, --ports <PORTS>         Port specification (e.g., 80,443,1000-2000, -1024, 60000-)
+        --top-ports <N>         Scan the N most common ports (max: 100), plus any -p ports
+        --exclude-ports <PORTS> Leave these ports out of the scan
+    -T, --timeout <MS>          Initial probe timeout in milliseconds (default: 3000)
     -j, --threads <N>           Number of threads (default: 100, max: 2000)
-    -s, --scan-type <TYPE>      Scan type: tcp, syn, udp, ack, fin (default: tcp)
+    -s, --scan-type <TYPE>      Scan type: tcp, syn, udp, ack, fin, null, xmas (default: tcp)
     -6, --ipv6                  Force IPv6 scanning
     -c, --config <FILE>         Load configuration from file (JSON/XML)
     -o, --output <FILE>         Output file path
-    -f, --format <FORMAT>       Output format: txt, json, xml (default: txt)
+    -f, --format <FORMAT>       Output format: txt, json, xml, ndjson, bin (default: txt)
+        --stream                With -f ndjson: write each result to the output file as it arrives
     -S, --no-service-detection  Disable service detection
     -B, --no-banner-grab        Disable banner grabbing
     -P, --performance           Enable high-performance mode
+    -R, --reactors <N>          Async event loops, one per core (default: online CPUs)
+        --backend <NAME>        Async backend: epoll, io_uring (default: epoll; io_uring with
+                                --max-retries needs Linux 6.7+, else epoll is used)
+        --stateless             SYN scan without per-probe state (no response times)
+        --rx-path <PATH>        Raw reply path: ring, socket (default: ring)
+        --tx-path <PATH>        Raw probe path: ring, socket (default: ring)
+        --rate <N>              Cap probes per second (default: unlimited)
+        --adaptive-rate         Back off on timeout/ICMP spikes, creep back up to --rate
+        --max-retries <N>       Re-probe timed-out ports up to N times, kernel SYN retries off (default: 0)
+        --retry-delay <MS>      Pause before each re-probe pass (default: 0)
+        --seed <N>              Key of the random probe order, to repeat a scan (default: random)
+        --no-randomize          Probe ports in order, alternating hosts
+        --shard <I/N>           Probe only shard I of N (1-based) of the --seed order
+        --checkpoint <FILE>     Snapshot progress and results to FILE while scanning
+        --checkpoint-interval <S>  Seconds between checkpoints (default: 30)
+        --resume <FILE>         Continue the scan saved in a checkpoint; keeps checkpointing to it
+        --discover              Ping targets first (ICMP echo, UDP, TCP connect); scan only live hosts
+        --ping-ports <PORTS>    TCP ports the discovery pings connect to; implies --discover (default: 80,443)
+        --min-rtt-timeout <MS>  Floor of the RTT-derived probe timeout (default: 100)
+        --max-rtt-timeout <MS>  Ceiling of the RTT-derived probe timeout (default: --timeout)
 
 EXAMPLES:
     PortScanner 192.168.1.1
     PortScanner -p 80,443,8080 -t google.com
+    PortScanner -P -p 22,80,443 192.168.1.0/24,10.0.0.1-50
     PortScanner -p 1-1000 -j 500 -T 5000 192.168.1.1
+    PortScanner --top-ports 50 --exclude-ports 23,135-139 192.168.1.0/24
     PortScanner -s syn -p 22,80,443 -v example.com
     PortScanner -c config.json -o results.xml -f xml
     PortScanner -P -j 1000 -p 1-65535 target.com
+    PortScanner -P --backend io_uring -p 1-65535 target.com
+    PortScanner -s syn --stateless -p 1-65535 target.com
+    PortScanner -P --rate 5000 --adaptive-rate -p 1-65535 target.com
+    PortScanner -P --seed 42 --shard 1/3 -f json -o part1.json -p 1-1024 10.0.0.0/16
+    PortScanner merge -o full.json -f json part1.json part2.json part3.json
+    PortScanner -f bin -o scan.bin -p 1-65535 10.0.0.0/24
+    PortScanner convert -f json -o scan.json scan.bin
+    PortScanner -P --checkpoint scan.ckpt -p 1-65535 10.0.0.0/24
+    PortScanner --resume scan.ckpt
+    PortScanner -P -f ndjson --stream -o results.ndjson -p 1-65535 10.0.0.0/16
+    PortScanner -P --discover --ping-ports 22,80,443 -p 1-1024 10.0.0.0/16
 
 ADVANCED FEATURES:
     - IPv6 support with automatic detection
@@ -234,6 +585,8 @@ NOTES:
     - SYN, ACK, FIN scans require root privileges
     - High-performance mode uses async I/O for better speed
     - Configuration files allow complex scan setups
+    - Shards with one --seed never overlap; merge reads their JSON/XML output
+    - Discovery echo pings fall back to unprivileged ping sockets without root
     - Results are automatically saved for successful scans
 )";
 }
@@ -7,68 +7,163 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <cerrno>
 #include <algorithm>
+#include <exception>
 #include <thread>
 
 namespace PortScanner {
 
-AsyncScanner::AsyncScanner(const ScanConfig& config) : config_(config), epoll_fd_(-1) {
-    setup_epoll();
+namespace {
+    // io_uring user_data layout: connection slot in the high bits, op in the low byte
+    enum UringOp : std::uint64_t {
+        URING_SOCKET = 1,
+        URING_SETSOCKOPT,
+        URING_CONNECT,
+        URING_TIMEOUT,
+        URING_CLOSE,
+        URING_PACE
+    };
+    
+    std::uint64_t uring_tag(std::size_t slot, UringOp op) {
+        return (static_cast<std::uint64_t>(slot) << 8) | op;
+    }
+    
+    // TCP_SYNCNT with --max-retries: one kernel SYN retransmission at most
+    const int SYN_COUNT = 1;
+    
+    // Most of an epoll loop's own work that counts toward connect deadlines
+    const auto MAX_BUSY = std::chrono::milliseconds(10);
+}
+
+AsyncScanner::AsyncScanner(const ScanConfig& config) : config_(config) {
 }
 
 AsyncScanner::~AsyncScanner() {
-    cleanup_epoll();
+    cancel();
+    finish_detection();
 }
 
 std::future<ScanResults> AsyncScanner::scan_async(ProgressCallback progress_cb) {
     return std::async(std::launch::async, [this, progress_cb]() {
-        ScanResults results;
         cancelled_.store(false);
         completed_ports_.store(0);
         open_ports_.store(0);
+        in_flight_.store(0);
+        limiter_ = RateLimiter::from_config(config_);
+        rtt_.clear();
+        for (std::size_t i = 0; i < config_.targets.size(); ++i) {
+            rtt_.emplace_back(config_);
+        }
+        {
+            std::lock_guard<std::mutex> lock(detect_mutex_);
+            detect_done_ = false;
+            detected_ = ScanResults::for_config(config_);
+        }
         
-        auto start_time = std::chrono::steady_clock::now();
+        pass_ = ProbeSpace(config_);
+        total_probes_ = pass_.size();
+        final_pass_ = config_.max_retries == 0;
+        ScanResults results = run_pass(progress_cb);
         
-        try {
-            // Create connections in batches for better performance
-            const std::size_t batch_size = std::min(config_.thread_count, config_.ports.size());
+        // With kernel SYN retries off, a lost SYN just times out: re-probe
+        // only those ports, in whole passes, once the first pass is over
+        for (std::size_t retry = 0; retry < config_.max_retries && !cancelled_.load(); ++retry) {
+            pass_ = ProbeSpace::from_results(results.extract(PortStatus::FILTERED), config_.targets);
+            if (pass_.size() == 0) break;
             
-            for (std::size_t i = 0; i < config_.ports.size() && !cancelled_.load(); i += batch_size) {
-                std::size_t end = std::min(i + batch_size, config_.ports.size());
-                std::vector<Port> batch_ports(config_.ports.begin() + i, config_.ports.begin() + end);
-                
-                if (create_connections(batch_ports)) {
-                    process_events(results, progress_cb);
-                }
-                
-                // Clean up connections for next batch
-                for (auto& conn : connections_) {
-                    if (conn.sockfd >= 0) {
-                        close(conn.sockfd);
-                    }
-                }
-                connections_.clear();
-                fd_to_connection_.clear();
-            }
-            
-        } catch (const std::exception& e) {
-            // Handle errors gracefully
+            completed_ports_.fetch_sub(pass_.size());
+            final_pass_ = retry + 1 == config_.max_retries;
+            std::this_thread::sleep_for(config_.retry_delay);
+            results.merge(run_pass(progress_cb));
+        }
+        
+        // Open ports are never retried, so their detection can outlast the passes
+        results.merge(finish_detection());
+        
+        if (progress_cb) {
+            progress_cb(completed_ports_.load(), total_probes_);
         }
         
         return results;
     });
 }
 
+ScanResults AsyncScanner::run_pass(const ProgressCallback& progress_cb) {
+    ScanResults results = ScanResults::for_config(config_);
+    
+    // Shard the probes across reactors, one per core by default.
+    // Keep a fixed number of connects in flight and start a new one
+    // as soon as any slot frees up, so one slow port never stalls the rest
+    const std::size_t reactor_count = resolve_reactor_count();
+    const std::size_t window = std::min(config_.thread_count, pass_.size());
+    const bool use_io_uring = uses_io_uring(config_);
+    
+    std::vector<Reactor> reactors(reactor_count);
+    std::vector<std::thread> threads;
+    
+    // The first reactor to fail (no epoll instance, no memory) cancels the
+    // rest; its error is rethrown once every thread is joined
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto fail = [this, &error, &error_mutex]() {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        cancelled_.store(true);
+    };
+    
+    try {
+        for (std::size_t i = 0; i < reactor_count; ++i) {
+            std::size_t share = window / reactor_count + (i < window % reactor_count ? 1 : 0);
+            setup_reactor(reactors[i], i, reactor_count, std::max<std::size_t>(share, 1), use_io_uring);
+        }
+        
+        threads.reserve(reactor_count - 1);
+        for (std::size_t i = 1; i < reactor_count; ++i) {
+            threads.emplace_back([this, &reactors, i, &progress_cb, &fail]() {
+                try {
+                    run_reactor(reactors[i], progress_cb);
+                } catch (...) {
+                    fail();
+                }
+            });
+        }
+        
+        run_reactor(reactors[0], progress_cb);
+    } catch (...) {
+        fail();
+    }
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    if (error) {
+        for (auto& reactor : reactors) {
+            cleanup_reactor(reactor);
+        }
+        std::rethrow_exception(error);
+    }
+    
+    // Reactors are joined: merge their results without any locking
+    for (auto& reactor : reactors) {
+        cleanup_reactor(reactor);
+        results.merge(std::move(reactor.results));
+    }
+    
+    return results;
+}
+
 void AsyncScanner::cancel() {
     cancelled_.store(true);
 }
 
 AsyncScanner::ScanStats AsyncScanner::get_stats() const {
     ScanStats stats;
-    stats.total_ports = config_.ports.size();
+    stats.total_ports = total_probes_;
     stats.completed_ports = completed_ports_.load();
     stats.open_ports = open_ports_.load();
-    stats.active_connections = connections_.size();
+    stats.active_connections = in_flight_.load();
     
     // Calculate ports per second (simplified)
     if (stats.completed_ports > 0) {
@@ -79,169 +174,623 @@ AsyncScanner::ScanStats AsyncScanner::get_stats() const {
     return stats;
 }
 
-void AsyncScanner::setup_epoll() {
-    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
-    if (epoll_fd_ < 0) {
-        throw std::runtime_error("Failed to create epoll instance");
+std::size_t AsyncScanner::resolve_reactor_count() const {
+    std::size_t count = config_.reactor_count;
+    
+    if (count == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        count = online > 0 ? static_cast<std::size_t>(online) : 1;
     }
+    
+    // Every reactor needs at least one probe and one connection slot
+    count = std::min(count, pass_.size());
+    count = std::min(count, config_.thread_count);
+    return std::max<std::size_t>(count, 1);
 }
 
-void AsyncScanner::cleanup_epoll() {
-    if (epoll_fd_ >= 0) {
-        close(epoll_fd_);
-        epoll_fd_ = -1;
+void AsyncScanner::setup_reactor(Reactor& reactor, std::size_t index, std::size_t count,
+                                 std::size_t window, bool use_io_uring) {
+    reactor.results = ScanResults::for_config(config_);
+    
+    if (use_io_uring) {
+        // Socket, connect and link-timeout per probe, plus a close per slot;
+        // sockets live in a sparse fixed-file table indexed by slot
+        try {
+            reactor.ring = std::make_unique<IoUring>(static_cast<unsigned>(window * 4),
+                                                     static_cast<unsigned>(window));
+        } catch (const std::exception&) {
+            // Ring limits exceeded: this reactor falls back to epoll
+            reactor.ring.reset();
+        }
     }
     
-    for (auto& conn : connections_) {
-        if (conn.sockfd >= 0) {
-            close(conn.sockfd);
+    if (!reactor.ring) {
+        reactor.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (reactor.epoll_fd < 0) {
+            throw std::runtime_error("Failed to create epoll instance");
         }
     }
-    connections_.clear();
-    fd_to_connection_.clear();
+    
+    reactor.connections.assign(window, Connection{});
+    reactor.timers.reset(window);
+    reactor.clock = TimerWheel::Clock::now();
+    reactor.free_slots.clear();
+    for (std::size_t slot = window; slot > 0; --slot) {
+        reactor.free_slots.push_back(slot - 1);
+    }
+    
+    reactor.next_index = index;
+    reactor.stride = count;
+    reactor.in_flight = 0;
 }
 
-bool AsyncScanner::create_connections(const std::vector<Port>& ports) {
-    connections_.reserve(ports.size());
+void AsyncScanner::cleanup_reactor(Reactor& reactor) {
+    if (reactor.ring) {
+        // Tearing down the ring cancels outstanding ops and drops the fixed files
+        reactor.ring.reset();
+        in_flight_.fetch_sub(reactor.in_flight);
+        reactor.in_flight = 0;
+        reactor.connections.clear();
+        reactor.free_slots.clear();
+        return;
+    }
+    
+    for (std::size_t slot = 0; slot < reactor.connections.size(); ++slot) {
+        if (reactor.connections[slot].sockfd >= 0) {
+            release_connection(reactor, slot);
+        }
+    }
+    reactor.connections.clear();
+    reactor.free_slots.clear();
     
-    for (Port port : ports) {
-        if (cancelled_.load()) break;
+    if (reactor.epoll_fd >= 0) {
+        close(reactor.epoll_fd);
+        reactor.epoll_fd = -1;
+    }
+}
+
+void AsyncScanner::fill_window(Reactor& reactor, const ProgressCallback& progress_cb) {
+    while (has_pending(reactor) && !cancelled_.load()) {
+        // Every reactor draws from the one bucket, so the cap is scan-wide
+        if (limiter_ && limiter_->try_acquire() == 0) break;
         
-        try {
-            int sockfd = create_socket_for_target();
-            if (sockfd < 0) continue;
-            
-            set_socket_options(sockfd);
-            NetworkUtils::set_socket_nonblocking(sockfd);
-            
-            Connection conn;
-            conn.sockfd = sockfd;
-            conn.port = port;
-            conn.start_time = std::chrono::steady_clock::now();
-            
-            // Add to epoll
-            epoll_event event;
-            event.events = EPOLLOUT | EPOLLET;
-            event.data.fd = sockfd;
-            
-            if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, sockfd, &event) == 0) {
-                std::size_t conn_idx = connections_.size();
-                connections_.push_back(conn);
-                fd_to_connection_[sockfd] = conn_idx;
-                
-                // Start non-blocking connect
-                sockaddr_in addr = NetworkUtils::create_sockaddr(config_.target, port);
-                connect(sockfd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
-            } else {
-                close(sockfd);
-            }
+        std::size_t slot = reactor.free_slots.back();
+        const ProbeTarget probe = pass_[reactor.next_index];
+        
+        if (!open_connection(reactor, slot, probe)) {
+            // Out of descriptors: retry this port once a slot frees up
+            if (reactor.in_flight > 0) break;
             
-        } catch (const std::exception&) {
-            // Skip this port on error
+            store_result(reactor, probe, make_result(probe, PortStatus::UNKNOWN, std::chrono::steady_clock::now()));
+            completed_ports_.fetch_add(1);
+        }
+        
+        reactor.next_index += reactor.stride;
+        
+        if (reactor.connections[slot].sockfd < 0) {
+            report_progress(progress_cb);
         }
     }
+}
+
+bool AsyncScanner::has_pending(const Reactor& reactor) const {
+    return !reactor.free_slots.empty() && reactor.next_index < pass_.size();
+}
+
+int AsyncScanner::pacing_timeout_ms(const Reactor& reactor, int timeout_ms) {
+    if (!limiter_ || !has_pending(reactor)) return timeout_ms;
+    
+    // Round up so we never wake before the token is there
+    const auto delay = limiter_->delay();
+    const auto delay_ms = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(delay).count());
+    return timeout_ms < 0 ? delay_ms : std::min(timeout_ms, delay_ms);
+}
+
+void AsyncScanner::arm_pacing(Reactor& reactor) {
+    if (!limiter_ || reactor.pace_armed || !has_pending(reactor)) return;
+    
+    // A free slot is waiting on a token: queue a plain timeout so the next
+    // submit-and-wait returns when it is due, even with nothing in flight
+    io_uring_sqe* sqe = next_sqe(reactor);
+    if (!sqe) return;
+    
+    const auto delay = limiter_->delay().count();
+    reactor.pace.tv_sec = delay / 1000000000;
+    reactor.pace.tv_nsec = delay % 1000000000;
+    
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&reactor.pace);
+    sqe->len = 1;
+    sqe->user_data = uring_tag(0, URING_PACE);
+    reactor.pace_armed = true;
+}
+
+void AsyncScanner::record_outcome(const Connection& conn, bool answered) {
+    // Any answer, refusals included, is a round-trip sample for its target
+    if (answered) {
+        rtt_[conn.host].add_sample(std::chrono::steady_clock::now() - conn.start_time);
+    }
     
-    return !connections_.empty();
+    if (!limiter_) return;
+    
+    if (answered) {
+        limiter_->on_reply();
+    } else {
+        limiter_->on_loss();
+    }
 }
 
-void AsyncScanner::process_events(ScanResults& results, ProgressCallback progress_cb) {
+bool AsyncScanner::open_connection(Reactor& reactor, std::size_t slot, const ProbeTarget& probe) {
+    if (reactor.ring) {
+        return queue_probe(reactor, slot, probe);
+    }
+    
+    const IPAddress& host = config_.targets[probe.host];
+    int sockfd = create_socket_for_target(host);
+    if (sockfd < 0) return false;
+    
+    set_socket_options(sockfd);
+    NetworkUtils::set_socket_nonblocking(sockfd);
+    
+    auto start_time = std::chrono::steady_clock::now();
+    
+    try {
+        sockaddr_in addr = NetworkUtils::create_sockaddr(host, probe.port);
+        
+        // Add to epoll, keyed by slot so completions need no fd lookup
+        epoll_event event;
+        event.events = EPOLLOUT | EPOLLET;
+        event.data.u64 = slot;
+        
+        if (epoll_ctl(reactor.epoll_fd, EPOLL_CTL_ADD, sockfd, &event) != 0) {
+            close(sockfd);
+            return false;
+        }
+        
+        Connection& conn = reactor.connections[slot];
+        conn.sockfd = sockfd;
+        conn.host = probe.host;
+        conn.port = probe.port;
+        conn.start_time = start_time;
+        conn.deadline = reactor.clock + rtt_[probe.host].timeout();
+        conn.connected = false;
+        reactor.free_slots.pop_back();
+        reactor.in_flight++;
+        in_flight_.fetch_add(1);
+        reactor.timers.schedule(slot, conn.deadline);
+        
+        // Start non-blocking connect
+        if (connect(sockfd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 &&
+            errno != EINPROGRESS) {
+            // Refused or unreachable before the handshake even started
+            record_outcome(conn, errno == ECONNREFUSED);
+            store_result(reactor, probe, make_result(probe, PortStatus::CLOSED, start_time));
+            completed_ports_.fetch_add(1);
+            release_connection(reactor, slot);
+        }
+        
+    } catch (const std::exception&) {
+        // Invalid target address for this socket family
+        close(sockfd);
+        return false;
+    }
+    
+    return true;
+}
+
+void AsyncScanner::release_connection(Reactor& reactor, std::size_t slot) {
+    Connection& conn = reactor.connections[slot];
+    
+    reactor.timers.cancel(slot);
+    
+    // Remove from epoll and close socket
+    epoll_ctl(reactor.epoll_fd, EPOLL_CTL_DEL, conn.sockfd, nullptr);
+    close(conn.sockfd);
+    conn.sockfd = -1;
+    
+    reactor.free_slots.push_back(slot);
+    reactor.in_flight--;
+    in_flight_.fetch_sub(1);
+}
+
+void AsyncScanner::expire_connections(Reactor& reactor, const ProgressCallback& progress_cb) {
+    reactor.expired.clear();
+    reactor.timers.advance(reactor.clock, reactor.expired);
+    
+    for (TimerWheel::TimerId slot : reactor.expired) {
+        const Connection& conn = reactor.connections[slot];
+        if (conn.sockfd < 0) continue;
+        
+        // No answer before this connection's own deadline - filtered
+        record_outcome(conn, false);
+        const ProbeTarget probe{conn.host, conn.port};
+        store_result(reactor, probe, make_result(probe, PortStatus::FILTERED, conn.start_time));
+        completed_ports_.fetch_add(1);
+        release_connection(reactor, slot);
+        
+        report_progress(progress_cb);
+    }
+}
+
+void AsyncScanner::run_reactor(Reactor& reactor, const ProgressCallback& progress_cb) {
+    if (reactor.ring) {
+        run_reactor_uring(reactor, progress_cb);
+        return;
+    }
+    
     const int max_events = 1000;
     epoll_event events[max_events];
     
-    auto timeout_ms = static_cast<int>(config_.timeout.count());
-    std::size_t processed = 0;
+    // Deadlines run on the reactor's own clock: time blocked in epoll_wait
+    // counts in full, time spent handling events only up to MAX_BUSY per
+    // loop, so a reactor that falls behind never takes its own stall for
+    // silence from the network
+    auto busy_since = TimerWheel::Clock::now();
     
-    while (processed < connections_.size() && !cancelled_.load()) {
-        int event_count = epoll_wait(epoll_fd_, events, max_events, timeout_ms);
+    while (!cancelled_.load()) {
+        fill_window(reactor, progress_cb);
+        if (reactor.in_flight == 0 && !has_pending(reactor)) break;
         
-        if (event_count < 0) break;
+        // Sleep only until the nearest deadline; rate-limited, also wake up
+        // when the next token is due (with nothing in flight, epoll_wait
+        // simply sleeps until then)
+        const auto wait_start = TimerWheel::Clock::now();
+        reactor.clock += std::min<TimerWheel::Clock::duration>(wait_start - busy_since, MAX_BUSY);
+        int timeout_ms = reactor.timers.next_timeout_ms(reactor.clock);
+        timeout_ms = pacing_timeout_ms(reactor, timeout_ms);
         
-        if (event_count == 0) {
-            // Timeout - mark remaining connections as closed/filtered
-            for (auto& conn : connections_) {
-                if (!conn.connected) {
-                    auto end_time = std::chrono::steady_clock::now();
-                    auto response_time = std::chrono::duration_cast<Duration>(end_time - conn.start_time);
-                    
-                    ScanResult result;
-                    result.port = conn.port;
-                    result.status = PortStatus::FILTERED;
-                    result.response_time = response_time;
-                    result.ip_version = is_ipv6_address(config_.target) ? IPVersion::IPv6 : IPVersion::IPv4;
-                    
-                    results.add_result(result);
-                    processed++;
-                }
+        int event_count = epoll_wait(reactor.epoll_fd, events, max_events, timeout_ms);
+        busy_since = TimerWheel::Clock::now();
+        reactor.clock += busy_since - wait_start;
+        if (event_count < 0 && errno != EINTR) break;
+        
+        // A full batch may leave answers queued: take them all before any
+        // deadline is checked, so a connect is never timed out with its
+        // reply already in
+        while (event_count > 0) {
+            for (int i = 0; i < event_count; ++i) {
+                handle_connection_event(reactor, events[i]);
+                report_progress(progress_cb);
             }
-            break;
+            if (event_count < max_events) break;
+            event_count = epoll_wait(reactor.epoll_fd, events, max_events, 0);
         }
         
-        for (int i = 0; i < event_count; ++i) {
-            handle_connection_event(events[i], results);
-            processed++;
-            
-            if (progress_cb) {
-                progress_cb(completed_ports_.load(), config_.ports.size());
-            }
+        expire_connections(reactor, progress_cb);
+    }
+}
+
+void AsyncScanner::handle_connection_event(Reactor& reactor, const epoll_event& event) {
+    std::size_t slot = static_cast<std::size_t>(event.data.u64);
+    if (slot >= reactor.connections.size()) return;
+    
+    Connection& conn = reactor.connections[slot];
+    if (conn.sockfd < 0) return;
+    
+    ScanResult result = make_result(ProbeTarget{conn.host, conn.port}, PortStatus::CLOSED, conn.start_time);
+    
+    // Connection attempt completed
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(conn.sockfd, SOL_SOCKET, SO_ERROR, &error, &len) != 0) {
+        error = errno;
+    }
+    
+    if ((event.events & EPOLLOUT) && error == 0) {
+        // Connection successful
+        result.status = PortStatus::OPEN;
+        conn.connected = true;
+        open_ports_.fetch_add(1);
+    }
+    
+    // A refusal is an answer; unreachables are ICMP errors
+    record_outcome(conn, error == 0 || error == ECONNREFUSED);
+    
+    // EPOLLERR / EPOLLHUP or a failed connect leave the port CLOSED
+    if (result.status == PortStatus::OPEN && config_.service_detection) {
+        queue_detection(ProbeTarget{conn.host, conn.port}, std::move(result));
+    } else {
+        store_result(reactor, ProbeTarget{conn.host, conn.port}, std::move(result));
+    }
+    completed_ports_.fetch_add(1);
+    
+    release_connection(reactor, slot);
+}
+
+void AsyncScanner::detect_open_service(ScanResult& result) {
+    // Perform service detection if enabled
+    if (config_.service_detection) {
+        ServiceDetector detector;
+        result.service = detector.detect_service(result.host, result.port);
+        
+        if (config_.banner_grabbing) {
+            result.banner = detector.grab_banner(result.host, result.port, Duration{2000});
         }
     }
 }
 
-void AsyncScanner::handle_connection_event(const epoll_event& event, ScanResults& results) {
-    int sockfd = event.data.fd;
-    auto it = fd_to_connection_.find(sockfd);
+void AsyncScanner::queue_detection(const ProbeTarget& probe, ScanResult result) {
+    std::lock_guard<std::mutex> lock(detect_mutex_);
+    detect_queue_.push_back(Detection{probe, std::move(result)});
     
-    if (it == fd_to_connection_.end()) return;
+    // Add a detector while every one is busy, up to the cap
+    if (idle_detectors_ == 0 && detectors_.size() < DETECTION_THREADS) {
+        detectors_.emplace_back([this]() { detection_loop(); });
+    } else {
+        detect_cv_.notify_one();
+    }
+}
+
+void AsyncScanner::detection_loop() {
+    std::unique_lock<std::mutex> lock(detect_mutex_);
     
-    Connection& conn = connections_[it->second];
-    auto end_time = std::chrono::steady_clock::now();
-    auto response_time = std::chrono::duration_cast<Duration>(end_time - conn.start_time);
+    for (;;) {
+        ++idle_detectors_;
+        detect_cv_.wait(lock, [this]() { return !detect_queue_.empty() || detect_done_; });
+        --idle_detectors_;
+        if (detect_queue_.empty()) return;
+        
+        Detection detection = std::move(detect_queue_.front());
+        detect_queue_.pop_front();
+        lock.unlock();
+        
+        // A cancelled scan keeps its open ports, without service details
+        if (!cancelled_.load()) {
+            detect_open_service(detection.result);
+        }
+        if (sink_ && !cancelled_.load()) {
+            sink_->record(detection.probe, detection.result);
+        }
+        
+        lock.lock();
+        detected_.add_result(std::move(detection.result));
+    }
+}
+
+ScanResults AsyncScanner::finish_detection() {
+    {
+        std::lock_guard<std::mutex> lock(detect_mutex_);
+        detect_done_ = true;
+    }
+    detect_cv_.notify_all();
     
-    ScanResult result;
-    result.port = conn.port;
-    result.response_time = response_time;
-    result.ip_version = is_ipv6_address(config_.target) ? IPVersion::IPv6 : IPVersion::IPv4;
-    
-    if (event.events & EPOLLOUT) {
-        // Connection attempt completed
-        int error = 0;
-        socklen_t len = sizeof(error);
+    // Detectors exit once the queue is empty; none is added after this
+    for (auto& detector : detectors_) {
+        detector.join();
+    }
+    detectors_.clear();
+    
+    return std::move(detected_);
+}
+
+void AsyncScanner::run_reactor_uring(Reactor& reactor, const ProgressCallback& progress_cb) {
+    io_uring_cqe cqe;
+    
+    while (!cancelled_.load()) {
+        fill_window(reactor, progress_cb);
+        if (reactor.in_flight == 0 && !has_pending(reactor)) break;
         
-        if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
-            // Connection successful
-            result.status = PortStatus::OPEN;
-            conn.connected = true;
-            open_ports_.fetch_add(1);
-            
-            // Perform service detection if enabled
-            if (config_.service_detection) {
-                ServiceDetector detector;
-                result.service = detector.detect_service(config_.target, conn.port);
-                
-                if (config_.banner_grabbing) {
-                    result.banner = detector.grab_banner(config_.target, conn.port, Duration{2000});
-                }
-            }
-        } else {
-            // Connection failed
-            result.status = PortStatus::CLOSED;
+        // One syscall submits every queued probe and waits for a completion;
+        // link timeouts guarantee each probe completes by its deadline, and
+        // a pacing timeout wakes us for the next rate token
+        arm_pacing(reactor);
+        if (reactor.ring->submit(1) < 0) break;
+        
+        // Take every completion posted so far before classifying any probe,
+        // then classify; detection for open ports runs off this loop
+        while (reactor.ring->pop_cqe(cqe)) {
+            handle_completion(reactor, cqe);
+        }
+        for (std::size_t slot : reactor.finished) {
+            finish_probe(reactor, slot);
         }
-    } else if (event.events & (EPOLLERR | EPOLLHUP)) {
-        // Connection error
-        result.status = PortStatus::CLOSED;
+        reactor.finished.clear();
+        
+        report_progress(progress_cb);
     }
+}
+
+bool AsyncScanner::uses_io_uring(const ScanConfig& config) {
+    // Retries need TCP_SYNCNT on every socket, set from the ring itself
+    return config.async_backend == AsyncBackend::IO_URING && IoUring::is_supported() &&
+           (config.max_retries == 0 || IoUring::supports_setsockopt());
+}
+
+bool AsyncScanner::queue_probe(Reactor& reactor, std::size_t slot, const ProbeTarget& probe) {
+    const bool syn_count = config_.max_retries > 0;
+    if (reactor.ring->sq_space_left() < (syn_count ? 4u : 3u)) return false;
+    
+    Connection& conn = reactor.connections[slot];
     
-    results.add_result(result);
+    try {
+        conn.addr = NetworkUtils::create_sockaddr(config_.targets[probe.host], probe.port);
+    } catch (const std::exception&) {
+        // Invalid target address for this socket family
+        return false;
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    conn.sockfd = static_cast<int>(slot);  // fixed-file index
+    conn.host = probe.host;
+    conn.port = probe.port;
+    conn.start_time = start_time;
+    const auto timeout = rtt_[probe.host].timeout();
+    conn.deadline = start_time + timeout;
+    conn.connected = false;
+    conn.timeout.tv_sec = timeout.count() / 1000000000;
+    conn.timeout.tv_nsec = timeout.count() % 1000000000;
+    conn.pending = syn_count ? 4 : 3;
+    conn.socket_res = 0;
+    conn.option_res = 0;
+    conn.connect_res = 0;
+    
+    // socket -> [TCP_SYNCNT ->] connect -> link timeout, all in one linked chain
+    io_uring_sqe* sqe = reactor.ring->get_sqe();
+    sqe->opcode = IORING_OP_SOCKET;
+    sqe->fd = AF_INET;
+    sqe->off = SOCK_STREAM | SOCK_NONBLOCK;
+    sqe->file_index = static_cast<std::uint32_t>(slot + 1);
+    sqe->flags = IOSQE_IO_LINK;
+    sqe->user_data = uring_tag(slot, URING_SOCKET);
+    
+    if (syn_count) {
+        sqe = reactor.ring->get_sqe();
+        IoUring::prep_setsockopt(sqe, static_cast<int>(slot), IPPROTO_TCP, TCP_SYNCNT, &SYN_COUNT, sizeof(SYN_COUNT));
+        sqe->flags |= IOSQE_IO_LINK;
+        sqe->user_data = uring_tag(slot, URING_SETSOCKOPT);
+    }
+    
+    sqe = reactor.ring->get_sqe();
+    sqe->opcode = IORING_OP_CONNECT;
+    sqe->fd = static_cast<std::int32_t>(slot);
+    sqe->addr = reinterpret_cast<std::uint64_t>(&conn.addr);
+    sqe->off = sizeof(conn.addr);
+    sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+    sqe->user_data = uring_tag(slot, URING_CONNECT);
+    
+    sqe = reactor.ring->get_sqe();
+    sqe->opcode = IORING_OP_LINK_TIMEOUT;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&conn.timeout);
+    sqe->len = 1;
+    sqe->user_data = uring_tag(slot, URING_TIMEOUT);
+    
+    reactor.free_slots.pop_back();
+    reactor.in_flight++;
+    in_flight_.fetch_add(1);
+    
+    return true;
+}
+
+void AsyncScanner::handle_completion(Reactor& reactor, const io_uring_cqe& cqe) {
+    if ((cqe.user_data & 0xff) == URING_PACE) {
+        reactor.pace_armed = false;
+        return;
+    }
+    
+    std::size_t slot = static_cast<std::size_t>(cqe.user_data >> 8);
+    if (slot >= reactor.connections.size()) return;
+    
+    Connection& conn = reactor.connections[slot];
+    
+    switch (static_cast<UringOp>(cqe.user_data & 0xff)) {
+        case URING_SOCKET:
+            conn.socket_res = cqe.res;
+            break;
+        case URING_SETSOCKOPT:
+            conn.option_res = cqe.res;
+            break;
+        case URING_CONNECT:
+            conn.connect_res = cqe.res;
+            break;
+        case URING_TIMEOUT:
+        case URING_PACE:
+            break;
+        case URING_CLOSE:
+            // Fixed-file slot is empty again
+            conn.sockfd = -1;
+            reactor.free_slots.push_back(slot);
+            reactor.in_flight--;
+            in_flight_.fetch_sub(1);
+            return;
+    }
+    
+    if (--conn.pending == 0) {
+        reactor.finished.push_back(slot);
+    }
+}
+
+void AsyncScanner::finish_probe(Reactor& reactor, std::size_t slot) {
+    Connection& conn = reactor.connections[slot];
+    
+    // Same classification as the epoll path: a connect cut off by its link
+    // timeout is FILTERED, any other error means the port is CLOSED. A
+    // failed setsockopt cancels the connect, which then never ran
+    PortStatus status = PortStatus::CLOSED;
+    if (conn.socket_res < 0 || conn.option_res < 0) {
+        status = PortStatus::UNKNOWN;
+    } else if (conn.connect_res == 0) {
+        status = PortStatus::OPEN;
+    } else if (conn.connect_res == -ECANCELED || conn.connect_res == -ETIME) {
+        status = PortStatus::FILTERED;
+    }
+    
+    if (status != PortStatus::UNKNOWN) {
+        record_outcome(conn, conn.connect_res == 0 || conn.connect_res == -ECONNREFUSED);
+    }
+    
+    ScanResult result = make_result(ProbeTarget{conn.host, conn.port}, status, conn.start_time);
+    if (status == PortStatus::OPEN) {
+        conn.connected = true;
+        open_ports_.fetch_add(1);
+    }
+    
+    if (status == PortStatus::OPEN && config_.service_detection) {
+        queue_detection(ProbeTarget{conn.host, conn.port}, std::move(result));
+    } else {
+        store_result(reactor, ProbeTarget{conn.host, conn.port}, std::move(result));
+    }
     completed_ports_.fetch_add(1);
     
-    // Remove from epoll and close socket
-    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, sockfd, nullptr);
-    close(sockfd);
-    conn.sockfd = -1;
+    io_uring_sqe* sqe = conn.socket_res < 0 ? nullptr : next_sqe(reactor);
+    if (!sqe) {
+        // Nothing installed in the fixed-file slot (or no room to close it;
+        // the next socket installed there replaces it)
+        conn.sockfd = -1;
+        reactor.free_slots.push_back(slot);
+        reactor.in_flight--;
+        in_flight_.fetch_sub(1);
+        return;
+    }
+    
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->file_index = static_cast<std::uint32_t>(slot + 1);
+    sqe->user_data = uring_tag(slot, URING_CLOSE);
 }
 
-int AsyncScanner::create_socket_for_target() {
-    if (is_ipv6_address(config_.target)) {
+io_uring_sqe* AsyncScanner::next_sqe(Reactor& reactor) {
+    io_uring_sqe* sqe = reactor.ring->get_sqe();
+    if (!sqe) {
+        // Queue full: hand what we have to the kernel to make room
+        reactor.ring->submit(0);
+        sqe = reactor.ring->get_sqe();
+    }
+    return sqe;
+}
+
+void AsyncScanner::report_progress(const ProgressCallback& progress_cb) {
+    if (!progress_cb) return;
+    
+    // Reactors never wait on each other; skip the update if another one is printing
+    std::unique_lock<std::mutex> lock(progress_mutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+        progress_cb(completed_ports_.load(), total_probes_);
+    }
+}
+
+void AsyncScanner::store_result(Reactor& reactor, const ProbeTarget& probe, ScanResult result) {
+    // A timeout may still be retried, and a cancelled probe never finished
+    if (sink_ && !cancelled_.load() && (result.status != PortStatus::FILTERED || final_pass_)) {
+        sink_->record(probe, result);
+    }
+    reactor.results.add_result(std::move(result));
+}
+
+ScanResult AsyncScanner::make_result(const ProbeTarget& probe, PortStatus status,
+                                     std::chrono::steady_clock::time_point start_time) {
+    auto end_time = std::chrono::steady_clock::now();
+    
+    ScanResult result;
+    result.host = config_.targets[probe.host];
+    result.port = probe.port;
+    result.status = status;
+    result.response_time = std::chrono::duration_cast<Duration>(end_time - start_time);
+    result.ip_version = is_ipv6_address(result.host) ? IPVersion::IPv6 : IPVersion::IPv4;
+    
+    return result;
+}
+
+int AsyncScanner::create_socket_for_target(const IPAddress& host) {
+    if (is_ipv6_address(host)) {
         return socket(AF_INET6, SOCK_STREAM, 0);
     } else {
         return socket(AF_INET, SOCK_STREAM, 0);
@@ -260,6 +809,12 @@ void AsyncScanner::set_socket_options(int sockfd) {
     // Set TCP_NODELAY for faster connection establishment
     setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
     
+    // Retries are ours: one kernel SYN retransmission at most (the minimum)
+    if (config_.max_retries > 0) {
+        int syn_count = 1;
+        setsockopt(sockfd, IPPROTO_TCP, TCP_SYNCNT, &syn_count, sizeof(syn_count));
+    }
+    
     // Set socket timeout
     struct timeval timeout;
     timeout.tv_sec = config_.timeout.count() / 1000;
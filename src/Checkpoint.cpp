@@ -0,0 +1,326 @@
+#include "Checkpoint.h"
+#include "ConfigManager.h"
+#include "ResultSerializer.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PortScanner {
+
+namespace {
+    const char* const HEADER = "PortScanner checkpoint v2";
+    
+    // The scan a checkpoint describes, without the runs of an earlier resume
+    ScanConfig full_pass(const ScanConfig& config) {
+        ScanConfig full = config;
+        full.pending.clear();
+        return full;
+    }
+}
+
+Checkpoint::Checkpoint(const ScanConfig& config, const ScanResults& completed)
+    : config_(full_pass(config)), base_(config_) {
+    const std::size_t size = base_.size();
+    done_.assign((size + 63) / 64, 0);
+    
+    // Resuming: every position outside the pending runs is already done
+    if (!config.pending.empty()) {
+        for (std::size_t i = 0; i < size; ++i) {
+            done_[i / 64] |= std::uint64_t{1} << (i % 64);
+        }
+        for (const auto& run : config.pending) {
+            for (std::uint64_t i = run.first; i < run.second && i < size; ++i) {
+                done_[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+            }
+        }
+    }
+    pending_.reserve(FLUSH_BYTES * 2);
+    batch_.reserve(FLUSH_BYTES * 2);
+    
+    // Fail now rather than hours into the scan
+    if (!rewrite_log(completed) || !save()) {
+        throw std::runtime_error("Cannot write checkpoint file: " + config_.checkpoint_file);
+    }
+    
+    writer_ = std::thread([this]() { write_loop(); });
+}
+
+Checkpoint::~Checkpoint() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+void Checkpoint::record(const ProbeTarget& probe, const ScanResult& result) {
+    const std::int64_t position = base_.index_of(probe.host, probe.port);
+    if (position < 0) return;
+    
+    // Formatted before taking the lock; the writer drops repeats
+    thread_local std::string line;
+    line.clear();
+    ResultSerializer::append_ndjson(line, result, true);
+    
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ += line;
+        pending_lines_.emplace_back(static_cast<std::uint64_t>(position), pending_.size());
+        full = pending_.size() >= FLUSH_BYTES;
+    }
+    if (full) {
+        wake_.notify_one();
+    }
+}
+
+bool Checkpoint::save() {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    
+    // The log first: the checkpoint must never cover lines it does not have
+    if (!append_pending()) {
+        return false;
+    }
+    return write_file(pending_runs(done_, base_.size()));
+}
+
+bool Checkpoint::save_complete(const ScanResults& results) {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        pending_lines_.clear();
+    }
+    std::fill(done_.begin(), done_.end(), ~std::uint64_t{0});
+    
+    return rewrite_log(results) && write_file({});
+}
+
+void Checkpoint::write_loop() {
+    auto next_snapshot = std::chrono::steady_clock::now() + config_.checkpoint_interval;
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    while (!stopping_) {
+        wake_.wait_until(lock, next_snapshot, [this]() { return stopping_ || pending_.size() >= FLUSH_BYTES; });
+        if (stopping_) break;
+        
+        lock.unlock();
+        if (std::chrono::steady_clock::now() >= next_snapshot) {
+            save();
+            next_snapshot = std::chrono::steady_clock::now() + config_.checkpoint_interval;
+        } else {
+            // A full buffer between snapshots goes to the log only
+            std::lock_guard<std::mutex> write_lock(write_mutex_);
+            append_pending();
+        }
+        lock.lock();
+    }
+}
+
+bool Checkpoint::append_pending() {
+    // Take the buffer and leave the emptied one behind, as ResultStream does
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch_.swap(pending_);
+        batch_lines_.swap(pending_lines_);
+    }
+    
+    std::size_t begin = 0;
+    for (const auto& [position, end] : batch_lines_) {
+        // A position's first outcome is the one kept
+        std::uint64_t& word = done_[position / 64];
+        const std::uint64_t bit = std::uint64_t{1} << (position % 64);
+        if (!(word & bit)) {
+            word |= bit;
+            log_.write(batch_.data() + begin, static_cast<std::streamsize>(end - begin));
+            log_size_ += end - begin;
+        }
+        begin = end;
+    }
+    batch_.clear();
+    batch_lines_.clear();
+    
+    log_.flush();
+    return static_cast<bool>(log_);
+}
+
+bool Checkpoint::rewrite_log(const ScanResults& results) {
+    const std::string filename = log_file(config_.checkpoint_file);
+    const std::string temporary = filename + ".tmp";
+    std::uint64_t size = 0;
+    
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        for (const auto& result : results.get_results()) {
+            ResultSerializer::append_ndjson(batch_, result, true);
+            if (batch_.size() >= FLUSH_BYTES) {
+                file.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+                size += batch_.size();
+                batch_.clear();
+            }
+        }
+        file.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+        size += batch_.size();
+        batch_.clear();
+        
+        file.flush();
+        if (!file) {
+            return false;
+        }
+    }
+    
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        return false;
+    }
+    
+    log_.close();
+    log_.clear();
+    log_.open(filename, std::ios::out | std::ios::app | std::ios::binary);
+    log_size_ = size;
+    return log_.is_open();
+}
+
+bool Checkpoint::write_file(const std::vector<std::pair<std::uint64_t, std::uint64_t>>& pending) const {
+    const std::string temporary = config_.checkpoint_file + ".tmp";
+    
+    {
+        std::ofstream file(temporary);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        file << HEADER << "\n";
+        ConfigManager::write_json(config_, file);
+        file << "shard " << config_.shard_index << " " << config_.shard_count << "\n";
+        file << "results " << log_size_ << "\n";
+        for (const auto& target : config_.targets) {
+            file << "target " << target << "\n";
+        }
+        for (const auto& run : pending) {
+            file << "pending " << run.first << " " << run.second << "\n";
+        }
+        
+        file.flush();
+        if (!file) {
+            return false;
+        }
+    }
+    
+    return std::rename(temporary.c_str(), config_.checkpoint_file.c_str()) == 0;
+}
+
+std::vector<std::pair<std::uint64_t, std::uint64_t>> Checkpoint::pending_runs(const std::vector<std::uint64_t>& done,
+                                                                              std::uint64_t size) {
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> runs;
+    std::uint64_t position = 0;
+    
+    while (position < size) {
+        // Skip done positions a word at a time
+        const std::uint64_t word = done[position / 64] >> (position % 64);
+        if (word == ~std::uint64_t{0} >> (position % 64)) {
+            position = (position / 64 + 1) * 64;
+            continue;
+        }
+        if (word & 1) {
+            position += __builtin_ctzll(~word);
+            continue;
+        }
+        
+        // First pending position: extend the run to the next done one
+        const std::uint64_t begin = position;
+        while (position < size) {
+            const std::uint64_t rest = done[position / 64] >> (position % 64);
+            if (rest != 0) {
+                position += __builtin_ctzll(rest);
+                break;
+            }
+            position = (position / 64 + 1) * 64;
+        }
+        position = std::min(position, size);
+        runs.emplace_back(begin, position);
+    }
+    
+    return runs;
+}
+
+Checkpoint::State Checkpoint::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open checkpoint file: " + filename);
+    }
+    
+    std::string line;
+    if (!std::getline(file, line) || line != HEADER) {
+        throw std::runtime_error(filename + " is not a PortScanner checkpoint");
+    }
+    
+    // The config block ends with the closing brace of its JSON object
+    std::string json;
+    while (std::getline(file, line)) {
+        json += line + "\n";
+        if (line == "}") break;
+    }
+    std::istringstream json_stream(json);
+    
+    State state{ConfigManager::read_json(json_stream), ScanResults{}};
+    ScanConfig& config = state.config;
+    config.targets.clear();
+    std::uint64_t log_size = 0;
+    bool has_log = false;
+    
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        
+        if (kind == "shard") {
+            fields >> config.shard_index >> config.shard_count;
+        } else if (kind == "target") {
+            IPAddress target;
+            fields >> target;
+            config.targets.push_back(target);
+        } else if (kind == "pending") {
+            std::uint64_t begin = 0;
+            std::uint64_t end = 0;
+            fields >> begin >> end;
+            if (fields && begin < end) {
+                config.pending.emplace_back(begin, end);
+            }
+        } else if (kind == "results") {
+            fields >> log_size;
+            has_log = static_cast<bool>(fields);
+        }
+    }
+    
+    if (!has_log || config.targets.empty() || config.ports.empty() || config.shard_count == 0 ||
+        config.shard_index >= config.shard_count) {
+        throw std::runtime_error(filename + " is an incomplete checkpoint");
+    }
+    
+    // Lines a crash left past the last snapshot belong to no checkpoint
+    const std::string log = log_file(filename);
+    struct stat status{};
+    if (::stat(log.c_str(), &status) != 0 || static_cast<std::uint64_t>(status.st_size) < log_size) {
+        throw std::runtime_error(filename + " is missing results: " + log);
+    }
+    if (static_cast<std::uint64_t>(status.st_size) > log_size &&
+        ::truncate(log.c_str(), static_cast<off_t>(log_size)) != 0) {
+        throw std::runtime_error("Cannot truncate checkpoint results: " + log);
+    }
+    state.results = ScanResults::load_from_file(log);
+    
+    return state;
+}
+
+} // namespace PortScanner
\ No newline at end of file
@@ -38,7 +38,22 @@ ScanConfig ConfigManager::create_default_config() {
     config.scan_type = ScanType::TCP_CONNECT;
     config.ip_version = IPVersion::AUTO;
     config.timeout = DEFAULT_TIMEOUT;
+    config.min_rtt_timeout = DEFAULT_MIN_RTT_TIMEOUT;
+    config.max_rtt_timeout = Duration{0};
     config.thread_count = DEFAULT_THREAD_COUNT;
+    config.max_retries = 0;
+    config.retry_delay = Duration{0};
+    config.randomize = true;
+    config.seed = 0;
+    config.discover = false;
+    config.ping_ports = {80, 443};
+    config.reactor_count = 0;
+    config.async_backend = AsyncBackend::EPOLL;
+    config.stateless = false;
+    config.rx_ring = true;
+    config.tx_ring = true;
+    config.rate = 0;
+    config.adaptive_rate = false;
     config.verbose = false;
     config.service_detection = true;
     config.banner_grabbing = true;
@@ -53,6 +68,7 @@ ScanConfig ConfigManager::merge_configs(const ScanConfig& file_config, const Sca
     // CLI arguments override file config
     if (!cli_config.target.empty() && cli_config.target != "127.0.0.1") {
         merged.target = cli_config.target;
+        merged.targets = cli_config.targets;
     }
     
     if (!cli_config.ports.empty()) {
@@ -67,10 +83,59 @@ ScanConfig ConfigManager::merge_configs(const ScanConfig& file_config, const Sca
         merged.timeout = cli_config.timeout;
     }
     
+    if (cli_config.min_rtt_timeout != DEFAULT_MIN_RTT_TIMEOUT) {
+        merged.min_rtt_timeout = cli_config.min_rtt_timeout;
+    }
+    
+    if (cli_config.max_rtt_timeout != Duration{0}) {
+        merged.max_rtt_timeout = cli_config.max_rtt_timeout;
+    }
+    
     if (cli_config.thread_count != DEFAULT_THREAD_COUNT) {
         merged.thread_count = cli_config.thread_count;
     }
     
+    if (!cli_config.randomize) {
+        merged.randomize = false;
+    }
+    
+    if (cli_config.seed != 0) {
+        merged.seed = cli_config.seed;
+    }
+    
+    if (cli_config.discover) {
+        merged.discover = true;
+        merged.ping_ports = cli_config.ping_ports;
+    }
+    
+    // Sharding belongs to one process, never to a saved setup
+    merged.shard_index = cli_config.shard_index;
+    merged.shard_count = cli_config.shard_count;
+    
+    if (cli_config.max_retries != 0) {
+        merged.max_retries = cli_config.max_retries;
+    }
+    
+    if (cli_config.retry_delay != Duration{0}) {
+        merged.retry_delay = cli_config.retry_delay;
+    }
+    
+    if (cli_config.reactor_count != 0) {
+        merged.reactor_count = cli_config.reactor_count;
+    }
+    
+    if (cli_config.async_backend != AsyncBackend::EPOLL) {
+        merged.async_backend = cli_config.async_backend;
+    }
+    
+    merged.stateless = cli_config.stateless || file_config.stateless;
+    merged.rx_ring = cli_config.rx_ring && file_config.rx_ring;
+    merged.tx_ring = cli_config.tx_ring && file_config.tx_ring;
+    
+    if (cli_config.rate != 0) {
+        merged.rate = cli_config.rate;
+    }
+    merged.adaptive_rate = cli_config.adaptive_rate || file_config.adaptive_rate;
     merged.verbose = cli_config.verbose || file_config.verbose;
     
     if (!cli_config.output_file.empty()) {
@@ -80,6 +145,7 @@ ScanConfig ConfigManager::merge_configs(const ScanConfig& file_config, const Sca
     if (cli_config.output_format != "txt") {
         merged.output_format = cli_config.output_format;
     }
+    merged.stream = cli_config.stream;
     
     return merged;
 }
@@ -91,9 +157,21 @@ ScanConfig ConfigManager::load_json_config(const std::string& filename) {
         throw std::runtime_error("Cannot open config file: " + filename);
     }
     
+    return read_json(file);
+}
+
+ScanConfig ConfigManager::read_json(std::istream& file) {
     ScanConfig config = create_default_config();
     std::string line;
     
+    // Digits of the numeric value on the current line
+    auto number_value = [&line]() -> std::string {
+        std::string value = line.substr(line.find(':') + 1);
+        value.erase(std::remove_if(value.begin(), value.end(),
+                    [](char c) { return !std::isdigit(c); }), value.end());
+        return value;
+    };
+    
     // Simple JSON parsing (basic implementation)
     while (std::getline(file, line)) {
         // Remove whitespace
@@ -110,7 +188,7 @@ ScanConfig ConfigManager::load_json_config(const std::string& filename) {
             std::size_t end = line.find(']');
             if (start != std::string::npos && end != std::string::npos) {
                 std::string ports_str = line.substr(start, end - start);
-                config.ports = parse_port_string(ports_str);
+                config.ports = PortSet::parse(ports_str);
             }
         } else if (line.find("\"scan_type\":") != std::string::npos) {
             std::size_t start = line.find('"', line.find(':')) + 1;
@@ -118,6 +196,60 @@ ScanConfig ConfigManager::load_json_config(const std::string& filename) {
             if (start != std::string::npos && end != std::string::npos) {
                 config.scan_type = string_to_scan_type(line.substr(start, end - start));
             }
+        } else if (line.find("\"backend\":") != std::string::npos) {
+            std::size_t start = line.find('"', line.find(':')) + 1;
+            std::size_t end = line.find('"', start);
+            if (start != std::string::npos && end != std::string::npos) {
+                config.async_backend = string_to_backend(line.substr(start, end - start));
+            }
+        } else if (line.find("\"stateless\":") != std::string::npos) {
+            config.stateless = line.find("true") != std::string::npos;
+        } else if (line.find("\"rx_path\":") != std::string::npos) {
+            config.rx_ring = line.find("\"socket\"") == std::string::npos;
+        } else if (line.find("\"tx_path\":") != std::string::npos) {
+            config.tx_ring = line.find("\"socket\"") == std::string::npos;
+        } else if (line.find("\"rate\":") != std::string::npos) {
+            std::string rate_str = number_value();
+            if (!rate_str.empty()) {
+                config.rate = std::stoul(rate_str);
+            }
+        } else if (line.find("\"adaptive_rate\":") != std::string::npos) {
+            config.adaptive_rate = line.find("true") != std::string::npos;
+        } else if (line.find("\"randomize\":") != std::string::npos) {
+            config.randomize = line.find("false") == std::string::npos;
+        } else if (line.find("\"seed\":") != std::string::npos) {
+            std::string seed_str = number_value();
+            if (!seed_str.empty()) {
+                config.seed = std::stoull(seed_str);
+            }
+        } else if (line.find("\"discover\":") != std::string::npos) {
+            config.discover = line.find("true") != std::string::npos;
+        } else if (line.find("\"ping_ports\":") != std::string::npos) {
+            std::size_t start = line.find('[') + 1;
+            std::size_t end = line.find(']');
+            if (start != std::string::npos && end != std::string::npos) {
+                config.ping_ports = PortSet::parse(line.substr(start, end - start)).to_vector();
+            }
+        } else if (line.find("\"max_retries\":") != std::string::npos) {
+            std::string retries_str = number_value();
+            if (!retries_str.empty()) {
+                config.max_retries = std::stoul(retries_str);
+            }
+        } else if (line.find("\"retry_delay\":") != std::string::npos) {
+            std::string delay_str = number_value();
+            if (!delay_str.empty()) {
+                config.retry_delay = Duration{std::stoi(delay_str)};
+            }
+        } else if (line.find("\"min_rtt_timeout\":") != std::string::npos) {
+            std::string min_str = number_value();
+            if (!min_str.empty()) {
+                config.min_rtt_timeout = Duration{std::stoi(min_str)};
+            }
+        } else if (line.find("\"max_rtt_timeout\":") != std::string::npos) {
+            std::string max_str = number_value();
+            if (!max_str.empty()) {
+                config.max_rtt_timeout = Duration{std::stoi(max_str)};
+            }
         } else if (line.find("\"timeout\":") != std::string::npos) {
             std::size_t start = line.find(':') + 1;
             std::size_t end = line.find(',', start);
@@ -142,6 +274,18 @@ ScanConfig ConfigManager::load_json_config(const std::string& filename) {
             if (!threads_str.empty()) {
                 config.thread_count = std::stoul(threads_str);
             }
+        } else if (line.find("\"reactors\":") != std::string::npos) {
+            std::size_t start = line.find(':') + 1;
+            std::size_t end = line.find(',', start);
+            if (end == std::string::npos) end = line.length();
+            
+            std::string reactors_str = line.substr(start, end - start);
+            reactors_str.erase(std::remove_if(reactors_str.begin(), reactors_str.end(), 
+                              [](char c) { return !std::isdigit(c); }), reactors_str.end());
+            
+            if (!reactors_str.empty()) {
+                config.reactor_count = std::stoul(reactors_str);
+            }
         }
     }
     
@@ -154,27 +298,51 @@ bool ConfigManager::save_json_config(const ScanConfig& config, const std::string
         return false;
     }
     
+    write_json(config, file);
+    return true;
+}
+
+void ConfigManager::write_json(const ScanConfig& config, std::ostream& file) {
     file << "{\n";
     file << "  \"target\": \"" << config.target << "\",\n";
     file << "  \"ports\": [";
     
-    for (std::size_t i = 0; i < config.ports.size(); ++i) {
-        file << config.ports[i];
-        if (i < config.ports.size() - 1) file << ", ";
+    const char* separator = "";
+    for (Port port : config.ports) {
+        file << separator << port;
+        separator = ", ";
     }
     
     file << "],\n";
     file << "  \"scan_type\": \"" << scan_type_to_string(config.scan_type) << "\",\n";
     file << "  \"ip_version\": \"" << ip_version_to_string(config.ip_version) << "\",\n";
     file << "  \"timeout\": " << config.timeout.count() << ",\n";
+    file << "  \"min_rtt_timeout\": " << config.min_rtt_timeout.count() << ",\n";
+    file << "  \"max_rtt_timeout\": " << config.max_rtt_timeout.count() << ",\n";
     file << "  \"threads\": " << config.thread_count << ",\n";
+    file << "  \"max_retries\": " << config.max_retries << ",\n";
+    file << "  \"retry_delay\": " << config.retry_delay.count() << ",\n";
+    file << "  \"reactors\": " << config.reactor_count << ",\n";
+    file << "  \"backend\": \"" << backend_to_string(config.async_backend) << "\",\n";
+    file << "  \"stateless\": " << (config.stateless ? "true" : "false") << ",\n";
+    file << "  \"rx_path\": \"" << (config.rx_ring ? "ring" : "socket") << "\",\n";
+    file << "  \"tx_path\": \"" << (config.tx_ring ? "ring" : "socket") << "\",\n";
+    file << "  \"rate\": " << config.rate << ",\n";
+    file << "  \"adaptive_rate\": " << (config.adaptive_rate ? "true" : "false") << ",\n";
+    file << "  \"randomize\": " << (config.randomize ? "true" : "false") << ",\n";
+    file << "  \"seed\": " << config.seed << ",\n";
+    file << "  \"discover\": " << (config.discover ? "true" : "false") << ",\n";
+    file << "  \"ping_ports\": [";
+    for (std::size_t i = 0; i < config.ping_ports.size(); ++i) {
+        file << config.ping_ports[i];
+        if (i < config.ping_ports.size() - 1) file << ", ";
+    }
+    file << "],\n";
     file << "  \"verbose\": " << (config.verbose ? "true" : "false") << ",\n";
     file << "  \"service_detection\": " << (config.service_detection ? "true" : "false") << ",\n";
     file << "  \"banner_grabbing\": " << (config.banner_grabbing ? "true" : "false") << ",\n";
     file << "  \"output_format\": \"" << config.output_format << "\"\n";
     file << "}\n";
-    
-    return true;
 }
 
 ScanConfig ConfigManager::load_xml_config(const std::string& filename) {
@@ -211,9 +379,54 @@ ScanConfig ConfigManager::load_xml_config(const std::string& filename) {
     std::string timeout = extract_tag_value("timeout");
     if (!timeout.empty()) config.timeout = Duration{std::stoi(timeout)};
     
+    std::string min_rtt_timeout = extract_tag_value("min_rtt_timeout");
+    if (!min_rtt_timeout.empty()) config.min_rtt_timeout = Duration{std::stoi(min_rtt_timeout)};
+    
+    std::string max_rtt_timeout = extract_tag_value("max_rtt_timeout");
+    if (!max_rtt_timeout.empty()) config.max_rtt_timeout = Duration{std::stoi(max_rtt_timeout)};
+    
     std::string threads = extract_tag_value("threads");
     if (!threads.empty()) config.thread_count = std::stoul(threads);
     
+    std::string max_retries = extract_tag_value("max_retries");
+    if (!max_retries.empty()) config.max_retries = std::stoul(max_retries);
+    
+    std::string retry_delay = extract_tag_value("retry_delay");
+    if (!retry_delay.empty()) config.retry_delay = Duration{std::stoi(retry_delay)};
+    
+    std::string reactors = extract_tag_value("reactors");
+    if (!reactors.empty()) config.reactor_count = std::stoul(reactors);
+    
+    std::string backend = extract_tag_value("backend");
+    if (!backend.empty()) config.async_backend = string_to_backend(backend);
+    
+    std::string stateless = extract_tag_value("stateless");
+    if (!stateless.empty()) config.stateless = stateless == "true";
+    
+    std::string rx_path = extract_tag_value("rx_path");
+    if (!rx_path.empty()) config.rx_ring = rx_path != "socket";
+    
+    std::string tx_path = extract_tag_value("tx_path");
+    if (!tx_path.empty()) config.tx_ring = tx_path != "socket";
+    
+    std::string rate = extract_tag_value("rate");
+    if (!rate.empty()) config.rate = std::stoul(rate);
+    
+    std::string adaptive_rate = extract_tag_value("adaptive_rate");
+    if (!adaptive_rate.empty()) config.adaptive_rate = adaptive_rate == "true";
+    
+    std::string randomize = extract_tag_value("randomize");
+    if (!randomize.empty()) config.randomize = randomize != "false";
+    
+    std::string seed = extract_tag_value("seed");
+    if (!seed.empty()) config.seed = std::stoull(seed);
+    
+    std::string discover = extract_tag_value("discover");
+    if (!discover.empty()) config.discover = discover == "true";
+    
+    std::string ping_ports = extract_tag_value("ping_ports");
+    if (!ping_ports.empty()) config.ping_ports = PortSet::parse(ping_ports).to_vector();
+    
     return config;
 }
 
@@ -226,16 +439,31 @@ bool ConfigManager::save_xml_config(const ScanConfig& config, const std::string&
     file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
     file << "<scan_config>\n";
     file << "  <target>" << config.target << "</target>\n";
-    file << "  <ports>";
-    for (std::size_t i = 0; i < config.ports.size(); ++i) {
-        file << config.ports[i];
-        if (i < config.ports.size() - 1) file << ",";
-    }
-    file << "</ports>\n";
+    file << "  <ports>" << config.ports.to_string() << "</ports>\n";
     file << "  <scan_type>" << scan_type_to_string(config.scan_type) << "</scan_type>\n";
     file << "  <ip_version>" << ip_version_to_string(config.ip_version) << "</ip_version>\n";
     file << "  <timeout>" << config.timeout.count() << "</timeout>\n";
+    file << "  <min_rtt_timeout>" << config.min_rtt_timeout.count() << "</min_rtt_timeout>\n";
+    file << "  <max_rtt_timeout>" << config.max_rtt_timeout.count() << "</max_rtt_timeout>\n";
     file << "  <threads>" << config.thread_count << "</threads>\n";
+    file << "  <max_retries>" << config.max_retries << "</max_retries>\n";
+    file << "  <retry_delay>" << config.retry_delay.count() << "</retry_delay>\n";
+    file << "  <reactors>" << config.reactor_count << "</reactors>\n";
+    file << "  <backend>" << backend_to_string(config.async_backend) << "</backend>\n";
+    file << "  <stateless>" << (config.stateless ? "true" : "false") << "</stateless>\n";
+    file << "  <rx_path>" << (config.rx_ring ? "ring" : "socket") << "</rx_path>\n";
+    file << "  <tx_path>" << (config.tx_ring ? "ring" : "socket") << "</tx_path>\n";
+    file << "  <rate>" << config.rate << "</rate>\n";
+    file << "  <adaptive_rate>" << (config.adaptive_rate ? "true" : "false") << "</adaptive_rate>\n";
+    file << "  <randomize>" << (config.randomize ? "true" : "false") << "</randomize>\n";
+    file << "  <seed>" << config.seed << "</seed>\n";
+    file << "  <discover>" << (config.discover ? "true" : "false") << "</discover>\n";
+    file << "  <ping_ports>";
+    for (std::size_t i = 0; i < config.ping_ports.size(); ++i) {
+        file << config.ping_ports[i];
+        if (i < config.ping_ports.size() - 1) file << ",";
+    }
+    file << "</ping_ports>\n";
     file << "  <verbose>" << (config.verbose ? "true" : "false") << "</verbose>\n";
     file << "  <service_detection>" << (config.service_detection ? "true" : "false") << "</service_detection>\n";
     file << "  <banner_grabbing>" << (config.banner_grabbing ? "true" : "false") << "</banner_grabbing>\n";
@@ -245,21 +473,6 @@ bool ConfigManager::save_xml_config(const ScanConfig& config, const std::string&
     return true;
 }
 
-std::vector<Port> ConfigManager::parse_port_string(const std::string& port_str) {
-    std::vector<Port> ports;
-    std::istringstream iss(port_str);
-    std::string token;
-    
-    while (std::getline(iss, token, ',')) {
-        token.erase(std::remove_if(token.begin(), token.end(), ::isspace), token.end());
-        if (!token.empty()) {
-            ports.push_back(static_cast<Port>(std::stoi(token)));
-        }
-    }
-    
-    return ports;
-}
-
 ScanType ConfigManager::string_to_scan_type(const std::string& type_str) {
     std::string lower_type = type_str;
     std::transform(lower_type.begin(), lower_type.end(), lower_type.begin(), ::tolower);
@@ -269,6 +482,8 @@ ScanType ConfigManager::string_to_scan_type(const std::string& type_str) {
     if (lower_type == "udp") return ScanType::UDP;
     if (lower_type == "ack") return ScanType::TCP_ACK;
     if (lower_type == "fin") return ScanType::TCP_FIN;
+    if (lower_type == "null") return ScanType::TCP_NULL;
+    if (lower_type == "xmas") return ScanType::TCP_XMAS;
     
     return ScanType::TCP_CONNECT;
 }
@@ -280,6 +495,8 @@ std::string ConfigManager::scan_type_to_string(ScanType type) {
         case ScanType::UDP: return "udp";
         case ScanType::TCP_ACK: return "ack";
         case ScanType::TCP_FIN: return "fin";
+        case ScanType::TCP_NULL: return "null";
+        case ScanType::TCP_XMAS: return "xmas";
         default: return "tcp";
     }
 }
@@ -303,4 +520,21 @@ std::string ConfigManager::ip_version_to_string(IPVersion version) {
     }
 }
 
+AsyncBackend ConfigManager::string_to_backend(const std::string& backend_str) {
+    std::string lower_backend = backend_str;
+    std::transform(lower_backend.begin(), lower_backend.end(), lower_backend.begin(), ::tolower);
+    
+    if (lower_backend == "io_uring" || lower_backend == "uring") return AsyncBackend::IO_URING;
+    
+    return AsyncBackend::EPOLL;
+}
+
+std::string ConfigManager::backend_to_string(AsyncBackend backend) {
+    switch (backend) {
+        case AsyncBackend::EPOLL: return "epoll";
+        case AsyncBackend::IO_URING: return "io_uring";
+        default: return "epoll";
+    }
+}
+
 } // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "HostDiscovery.h"
+#include "NetworkUtils.h"
+#include <linux/errqueue.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace PortScanner {
+
+namespace {
+    constexpr Port UDP_PING_PORT = 40125;          // high and unassigned: expect port unreachable
+    constexpr char UDP_PAYLOAD[] = "ping";
+    constexpr std::size_t REPLY_BUFFER_SIZE = 512;
+    constexpr std::size_t CONTROL_BUFFER_SIZE = 128;
+    
+    // epoll tags for the shared sockets; connections use their slot
+    constexpr std::uint64_t ICMP_TAG = ~std::uint64_t{0};
+    constexpr std::uint64_t UDP_TAG = ~std::uint64_t{0} - 1;
+    
+    void watch(int epoll_fd, int fd, std::uint32_t events, std::uint64_t tag) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = tag;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+HostDiscovery::HostDiscovery(const ScanConfig& config) : config_(config), rtt_(config) {
+    hosts_.resize(config_.targets.size());
+    for (std::size_t i = 0; i < hosts_.size(); ++i) {
+        in_addr address{};
+        hosts_[i].ipv4 = inet_pton(AF_INET, config_.targets[i].c_str(), &address) == 1;
+        hosts_[i].address = address.s_addr;
+        if (hosts_[i].ipv4) {
+            index_.emplace(address.s_addr, static_cast<std::uint32_t>(i));
+            ++pinged_;
+        }
+    }
+    
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("Failed to create epoll instance");
+    }
+    
+    // Echo replies: a raw ICMP socket sees them all, a ping socket only its own
+    icmp_fd_ = socket(AF_INET, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP);
+    icmp_raw_ = icmp_fd_ >= 0;
+    if (icmp_fd_ < 0) {
+        icmp_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP);
+    }
+    if (icmp_fd_ >= 0) {
+        watch(epoll_fd_, icmp_fd_, EPOLLIN, ICMP_TAG);
+    }
+    echo_id_ = static_cast<std::uint16_t>(getpid());
+    
+    // UDP pings: port unreachable lands on the error queue (IP_RECVERR)
+    udp_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (udp_fd_ >= 0) {
+        int one = 1;
+        setsockopt(udp_fd_, IPPROTO_IP, IP_RECVERR, &one, sizeof(one));
+        watch(epoll_fd_, udp_fd_, EPOLLIN, UDP_TAG);
+    }
+    
+    const std::size_t window = std::max<std::size_t>(std::min(config_.thread_count, pinged_ * config_.ping_ports.size()), 1);
+    connections_.assign(window, Connection{});
+    timers_.reset(window);
+    for (std::size_t slot = window; slot > 0; --slot) {
+        free_slots_.push_back(slot - 1);
+    }
+}
+
+HostDiscovery::~HostDiscovery() {
+    for (std::size_t slot = 0; slot < connections_.size(); ++slot) {
+        if (connections_[slot].fd >= 0) close(connections_[slot].fd);
+    }
+    if (icmp_fd_ >= 0) close(icmp_fd_);
+    if (udp_fd_ >= 0) close(udp_fd_);
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+}
+
+std::vector<std::uint32_t> HostDiscovery::run() {
+    const std::int64_t start_ns = now_ns();
+    cancelled_.store(false);
+    limiter_ = RateLimiter::from_config(config_);
+    stats_ = DiscoveryStats{};
+    stats_.hosts = hosts_.size();
+    
+    const std::size_t connect_total = hosts_.size() * config_.ping_ports.size();
+    std::size_t next_ping = 0;
+    std::size_t next_connect = 0;
+    std::int64_t last_send_ns = start_ns;
+    epoll_event events[BATCH_SIZE];
+    
+    while (!cancelled_.load() && answered_ < pinged_) {
+        // Echo and UDP pings first: cheap, and they find hosts that drop every TCP port
+        for (std::size_t batch = 0; batch < BATCH_SIZE && next_ping < hosts_.size(); ++next_ping) {
+            if (!hosts_[next_ping].ipv4 || hosts_[next_ping].live) continue;
+            if (!take_token()) break;
+            
+            send_pings(static_cast<std::uint32_t>(next_ping));
+            last_send_ns = now_ns();
+            ++batch;
+        }
+        
+        // Then keep the connect window full, skipping hosts already found
+        while (!free_slots_.empty() && next_connect < connect_total) {
+            const auto host = static_cast<std::uint32_t>(next_connect / config_.ping_ports.size());
+            const Port port = config_.ping_ports[next_connect % config_.ping_ports.size()];
+            if (!hosts_[host].ipv4 || hosts_[host].live) {
+                ++next_connect;
+                continue;
+            }
+            if (!take_token()) break;
+            
+            open_connection(host, port);
+            last_send_ns = now_ns();
+            ++next_connect;
+        }
+        
+        // Everything sent and answered or timed out
+        const bool sending = next_ping < hosts_.size() || next_connect < connect_total;
+        const std::int64_t wait_ns = last_send_ns + rtt_.timeout().count() - now_ns();
+        if (!sending && timers_.empty() && wait_ns <= 0) {
+            break;
+        }
+        
+        int timeout_ms = sending ? 10 : static_cast<int>(std::max<std::int64_t>(wait_ns / 1000000 + 1, 1));
+        const int timer_ms = timers_.next_timeout_ms(Clock::now());
+        if (timer_ms >= 0) {
+            timeout_ms = std::min(timeout_ms, timer_ms);
+        }
+        if (sending && limiter_) {
+            const auto delay = std::chrono::ceil<std::chrono::milliseconds>(limiter_->delay()).count();
+            timeout_ms = std::min<int>(timeout_ms, static_cast<int>(std::max<std::int64_t>(delay, 1)));
+        }
+        
+        const int ready = epoll_wait(epoll_fd_, events, BATCH_SIZE, timeout_ms);
+        for (int i = 0; i < ready; ++i) {
+            const std::uint64_t tag = events[i].data.u64;
+            if (tag == ICMP_TAG) {
+                drain_icmp();
+            } else if (tag == UDP_TAG) {
+                drain_udp();
+            } else {
+                handle_connection(static_cast<std::size_t>(tag), events[i].events);
+            }
+        }
+        
+        // No SYN-ACK or RST before the deadline: this port says nothing
+        expired_.clear();
+        timers_.advance(Clock::now(), expired_);
+        for (TimerWheel::TimerId slot : expired_) {
+            if (connections_[slot].fd >= 0) {
+                if (limiter_) limiter_->on_loss();
+                release_connection(slot);
+            }
+        }
+    }
+    
+    for (std::size_t slot = 0; slot < connections_.size(); ++slot) {
+        if (connections_[slot].fd >= 0) release_connection(slot);
+    }
+    
+    // Hosts that cannot be pinged are not ruled out
+    std::vector<std::uint32_t> live;
+    std::int64_t latency_sum = 0;
+    for (std::size_t i = 0; i < hosts_.size(); ++i) {
+        const Host& host = hosts_[i];
+        if (host.live || !host.ipv4) {
+            live.push_back(static_cast<std::uint32_t>(i));
+        }
+        if (host.latency_ns >= 0) {
+            latency_sum += host.latency_ns;
+            stats_.max_latency = std::max(stats_.max_latency, std::chrono::nanoseconds(host.latency_ns));
+        }
+    }
+    
+    stats_.live = live.size();
+    stats_.elapsed = std::chrono::nanoseconds(now_ns() - start_ns);
+    if (answered_ > 0) {
+        stats_.mean_latency = std::chrono::nanoseconds(latency_sum / static_cast<std::int64_t>(answered_));
+    }
+    return live;
+}
+
+void HostDiscovery::cancel() {
+    cancelled_.store(true);
+}
+
+bool HostDiscovery::take_token() {
+    return !limiter_ || limiter_->try_acquire() > 0;
+}
+
+void HostDiscovery::send_pings(std::uint32_t host) {
+    Host& target = hosts_[host];
+    if (target.first_sent_ns == 0) {
+        target.first_sent_ns = now_ns();
+    }
+    
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    destination.sin_addr.s_addr = target.address;
+    
+    if (icmp_fd_ >= 0) {
+        // The host index rides in the sequence number (ping sockets rewrite the id)
+        icmphdr echo{};
+        echo.type = ICMP_ECHO;
+        echo.un.echo.id = htons(echo_id_);
+        echo.un.echo.sequence = htons(static_cast<std::uint16_t>(host));
+        echo.checksum = NetworkUtils::checksum(&echo, sizeof(echo));
+        if (sendto(icmp_fd_, &echo, sizeof(echo), 0, reinterpret_cast<const sockaddr*>(&destination),
+                   sizeof(destination)) >= 0) {
+            ++stats_.probes_sent;
+        }
+    }
+    
+    if (udp_fd_ >= 0) {
+        destination.sin_port = htons(UDP_PING_PORT);
+        if (sendto(udp_fd_, UDP_PAYLOAD, sizeof(UDP_PAYLOAD) - 1, 0, reinterpret_cast<const sockaddr*>(&destination),
+                   sizeof(destination)) >= 0) {
+            ++stats_.probes_sent;
+        }
+    }
+}
+
+void HostDiscovery::open_connection(std::uint32_t host, Port port) {
+    Host& target = hosts_[host];
+    if (target.first_sent_ns == 0) {
+        target.first_sent_ns = now_ns();
+    }
+    
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return;
+    
+    // RST on close: no TIME_WAIT, no lingering connection to a live service
+    linger no_linger{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &no_linger, sizeof(no_linger));
+    
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(port);
+    destination.sin_addr.s_addr = target.address;
+    ++stats_.probes_sent;
+    
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&destination), sizeof(destination)) == 0 ||
+        errno == ECONNREFUSED) {
+        close(fd);
+        mark_live(host);
+        return;
+    }
+    if (errno != EINPROGRESS) {
+        close(fd);
+        return;
+    }
+    
+    const std::size_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    connections_[slot] = Connection{fd, host};
+    watch(epoll_fd_, fd, EPOLLOUT, slot);
+    timers_.schedule(slot, Clock::now() + rtt_.timeout());
+}
+
+void HostDiscovery::release_connection(std::size_t slot) {
+    Connection& conn = connections_[slot];
+    timers_.cancel(slot);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    close(conn.fd);
+    conn.fd = -1;
+    free_slots_.push_back(slot);
+}
+
+void HostDiscovery::handle_connection(std::size_t slot, std::uint32_t events) {
+    Connection& conn = connections_[slot];
+    if (conn.fd < 0) return;
+    
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+        error = errno;
+    }
+    
+    // Accepted or refused, the host is there; unreachables say nothing about it
+    const std::uint32_t host = conn.host;
+    const bool answered = ((events & EPOLLOUT) && error == 0) || error == ECONNREFUSED;
+    release_connection(slot);
+    if (answered) {
+        mark_live(host);
+    }
+}
+
+void HostDiscovery::drain_icmp() {
+    std::uint8_t buffer[REPLY_BUFFER_SIZE];
+    
+    for (;;) {
+        sockaddr_in source{};
+        socklen_t source_length = sizeof(source);
+        const ssize_t received = recvfrom(icmp_fd_, buffer, sizeof(buffer), 0,
+                                          reinterpret_cast<sockaddr*>(&source), &source_length);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        
+        // A raw socket hands over the IP header too, and every ICMP message
+        std::size_t offset = 0;
+        if (icmp_raw_) {
+            if (static_cast<std::size_t>(received) < sizeof(iphdr)) continue;
+            offset = reinterpret_cast<const iphdr*>(buffer)->ihl * 4u;
+        }
+        if (static_cast<std::size_t>(received) < offset + sizeof(icmphdr)) continue;
+        
+        const auto* icmp = reinterpret_cast<const icmphdr*>(buffer + offset);
+        if (icmp->type != ICMP_ECHOREPLY) continue;
+        if (icmp_raw_ && ntohs(icmp->un.echo.id) != echo_id_) continue;
+        
+        auto it = index_.find(source.sin_addr.s_addr);
+        if (it != index_.end()) {
+            mark_live(it->second);
+        }
+    }
+}
+
+void HostDiscovery::drain_udp() {
+    char data[REPLY_BUFFER_SIZE];
+    char control[CONTROL_BUFFER_SIZE];
+    
+    for (;;) {
+        sockaddr_in address{};
+        iovec buffer{data, sizeof(data)};
+        msghdr header{};
+        header.msg_name = &address;
+        header.msg_namelen = sizeof(address);
+        header.msg_iov = &buffer;
+        header.msg_iovlen = 1;
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+        
+        // A datagram back is an answer as good as the port unreachable we expect
+        bool answered = recvmsg(udp_fd_, &header, MSG_DONTWAIT) >= 0;
+        if (!answered) {
+            header.msg_controllen = sizeof(control);
+            if (recvmsg(udp_fd_, &header, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+                if (errno == EINTR || errno == ECONNREFUSED || errno == EHOSTUNREACH) continue;
+                return;
+            }
+            
+            // Error queue: msg_name is the original destination
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+                if (cmsg->cmsg_level != IPPROTO_IP || cmsg->cmsg_type != IP_RECVERR) continue;
+                
+                const auto* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+                answered = error->ee_origin == SO_EE_ORIGIN_ICMP && error->ee_type == ICMP_DEST_UNREACH &&
+                           error->ee_code == ICMP_PORT_UNREACH;
+            }
+        }
+        
+        if (!answered) continue;
+        
+        auto it = index_.find(address.sin_addr.s_addr);
+        if (it != index_.end()) {
+            mark_live(it->second);
+        }
+    }
+}
+
+void HostDiscovery::mark_live(std::uint32_t host) {
+    Host& target = hosts_[host];
+    if (target.live) return;
+    
+    target.live = true;
+    target.latency_ns = now_ns() - target.first_sent_ns;
+    ++answered_;
+    rtt_.add_sample(std::chrono::nanoseconds(target.latency_ns));
+    if (limiter_) {
+        limiter_->on_reply();
+    }
+}
+
+std::int64_t HostDiscovery::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+}
+
+} // namespace PortScanner
\ No newline at end of file
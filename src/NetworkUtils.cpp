@@ -4,9 +4,23 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <ifaddrs.h>
+#include <linux/if_ether.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <sys/ioctl.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
 #include <stdexcept>
 #include <cstring>
+#include <cstdio>
 #include <regex>
+#include <algorithm>
+#include <unordered_set>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace PortScanner {
 
@@ -33,6 +47,93 @@ IPAddress NetworkUtils::resolve_hostname(const std::string& hostname) {
     return std::string(ip_str);
 }
 
+std::vector<IPAddress> NetworkUtils::expand_targets(const std::string& spec) {
+    std::vector<IPAddress> targets;
+    std::unordered_set<IPAddress> seen;
+    
+    auto add = [&](const IPAddress& address) {
+        if (!seen.insert(address).second) return;
+        if (targets.size() == MAX_TARGETS) {
+            throw std::runtime_error("Target list exceeds " + std::to_string(MAX_TARGETS) + " hosts");
+        }
+        targets.push_back(address);
+    };
+    
+    // Host-order address of an IPv4 literal or a hostname
+    auto to_host_order = [](const std::string& text) {
+        const std::string address = is_valid_ipv4(text) ? text : resolve_hostname(text);
+        return ntohl(create_sockaddr(address, 0).sin_addr.s_addr);
+    };
+    
+    auto add_range = [&](std::uint32_t first, std::uint32_t last) {
+        if (last - first >= MAX_TARGETS) {
+            throw std::runtime_error("Target list exceeds " + std::to_string(MAX_TARGETS) + " hosts");
+        }
+        for (std::uint64_t address = first; address <= last; ++address) {
+            const in_addr_t network_order = htonl(static_cast<std::uint32_t>(address));
+            char ip_str[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &network_order, ip_str, INET_ADDRSTRLEN);
+            add(ip_str);
+        }
+    };
+    
+    std::istringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if (item.empty()) continue;
+        
+        try {
+            const std::size_t slash = item.find('/');
+            const std::size_t dash = item.find('-');
+            
+            if (item.find(':') != std::string::npos) {
+                // IPv6 literal: scanned as given, no ranges
+                add(item);
+            } else if (slash != std::string::npos) {
+                const int prefix_length = std::stoi(item.substr(slash + 1));
+                if (prefix_length < 0 || prefix_length > 32) {
+                    throw std::runtime_error("bad prefix length");
+                }
+                
+                const std::uint32_t mask = prefix_length == 0 ? 0 : ~std::uint32_t{0} << (32 - prefix_length);
+                const std::uint32_t network = to_host_order(item.substr(0, slash)) & mask;
+                add_range(network, network | ~mask);
+            } else if (dash != std::string::npos && is_valid_ipv4(item.substr(0, dash))) {
+                // Hostnames may contain dashes; only an address starts a range
+                const std::string first = item.substr(0, dash);
+                const std::string last = item.substr(dash + 1);
+                const std::uint32_t start = to_host_order(first);
+                
+                std::uint32_t end;
+                if (is_valid_ipv4(last)) {
+                    end = to_host_order(last);
+                } else {
+                    const int octet = std::stoi(last);
+                    if (octet < 0 || octet > 255) {
+                        throw std::runtime_error("bad last octet");
+                    }
+                    end = (start & ~std::uint32_t{0xff}) | static_cast<std::uint32_t>(octet);
+                }
+                
+                if (end < start) {
+                    throw std::runtime_error("range ends before it starts");
+                }
+                add_range(start, end);
+            } else {
+                add(is_valid_ipv4(item) ? item : resolve_hostname(item));
+            }
+        } catch (const std::exception& e) {
+            throw std::runtime_error("Invalid target '" + item + "': " + e.what());
+        }
+    }
+    
+    if (targets.empty()) {
+        throw std::runtime_error("No targets specified");
+    }
+    return targets;
+}
+
 IPAddress NetworkUtils::get_local_ip() {
     struct ifaddrs *ifaddrs_ptr, *ifa;
     
@@ -67,6 +168,135 @@ IPAddress NetworkUtils::get_local_ip() {
     return local_ip;
 }
 
+IPAddress NetworkUtils::get_source_ip(const IPAddress& target) {
+    // Let the routing table pick the outgoing interface: connecting a UDP
+    // socket sends nothing but binds it to the right local address
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0) {
+        throw std::runtime_error("Failed to create UDP socket: " + std::string(strerror(errno)));
+    }
+    
+    sockaddr_in remote = create_sockaddr(target, 9);
+    sockaddr_in local{};
+    socklen_t len = sizeof(local);
+    
+    if (connect(sockfd, reinterpret_cast<struct sockaddr*>(&remote), sizeof(remote)) != 0 ||
+        getsockname(sockfd, reinterpret_cast<struct sockaddr*>(&local), &len) != 0) {
+        close(sockfd);
+        throw std::runtime_error("No route to " + target + ": " + std::string(strerror(errno)));
+    }
+    
+    close(sockfd);
+    
+    char ip_str[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &local.sin_addr, ip_str, INET_ADDRSTRLEN);
+    return std::string(ip_str);
+}
+
+LinkAddress NetworkUtils::resolve_link(const IPAddress& target) {
+    const in_addr_t target_ip = create_sockaddr(target, 0).sin_addr.s_addr;
+    const in_addr_t source_ip = create_sockaddr(get_source_ip(target), 0).sin_addr.s_addr;
+    
+    // The interface that owns the source address is the outgoing one
+    std::string interface;
+    struct ifaddrs* interfaces = nullptr;
+    if (getifaddrs(&interfaces) == 0) {
+        for (auto* ifa = interfaces; ifa; ifa = ifa->ifa_next) {
+            if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_INET &&
+                reinterpret_cast<sockaddr_in*>(ifa->ifa_addr)->sin_addr.s_addr == source_ip) {
+                interface = ifa->ifa_name;
+                break;
+            }
+        }
+        freeifaddrs(interfaces);
+    }
+    
+    LinkAddress link;
+    link.ifindex = interface.empty() ? 0 : static_cast<int>(if_nametoindex(interface.c_str()));
+    if (link.ifindex == 0) {
+        throw std::runtime_error("No interface for source address of " + target);
+    }
+    
+    // Links without an Ethernet header (loopback, tun) need no next-hop MAC
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ifreq request{};
+    std::strncpy(request.ifr_name, interface.c_str(), IFNAMSIZ - 1);
+    const bool known = sockfd >= 0 && ioctl(sockfd, SIOCGIFHWADDR, &request) == 0;
+    if (sockfd >= 0) close(sockfd);
+    
+    link.loopback = known && request.ifr_hwaddr.sa_family == ARPHRD_LOOPBACK;
+    if (!known || request.ifr_hwaddr.sa_family != ARPHRD_ETHER) return link;
+    
+    // Longest-prefix match in the kernel routing table for the gateway
+    in_addr_t next_hop = target_ip;
+    {
+        std::ifstream routes("/proc/net/route");
+        std::string line;
+        std::getline(routes, line);   // header
+        
+        long best_mask = -1;
+        while (std::getline(routes, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            unsigned long destination, gateway, flags, refcnt, use, metric, mask;
+            fields >> name >> std::hex >> destination >> gateway >> flags >> refcnt >> use >> metric >> mask;
+            
+            if (!fields || name != interface || (target_ip & mask) != destination) continue;
+            if (static_cast<long>(__builtin_popcountl(mask)) > best_mask) {
+                best_mask = __builtin_popcountl(mask);
+                next_hop = gateway != 0 ? static_cast<in_addr_t>(gateway) : target_ip;
+            }
+        }
+    }
+    
+    char next_hop_str[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &next_hop, next_hop_str, INET_ADDRSTRLEN);
+    
+    auto lookup_neighbour = [&]() {
+        std::ifstream arp("/proc/net/arp");
+        std::string line;
+        std::getline(arp, line);   // header
+        
+        while (std::getline(arp, line)) {
+            std::istringstream fields(line);
+            std::string ip, type, flags, mac, mask, device;
+            fields >> ip >> type >> flags >> mac >> mask >> device;
+            
+            // Flag 0x2 marks a complete entry
+            if (ip != next_hop_str || device != interface || !(std::stoul(flags, nullptr, 16) & 0x2)) continue;
+            
+            unsigned int bytes[6];
+            if (std::sscanf(mac.c_str(), "%x:%x:%x:%x:%x:%x",
+                            &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5]) == 6) {
+                for (int i = 0; i < 6; ++i) link.mac[i] = static_cast<std::uint8_t>(bytes[i]);
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    bool resolved = lookup_neighbour();
+    if (!resolved) {
+        // Not cached yet: a datagram to the target makes the kernel resolve the next hop
+        int probe = socket(AF_INET, SOCK_DGRAM, 0);
+        if (probe >= 0) {
+            sockaddr_in remote = create_sockaddr(target, 9);
+            sendto(probe, "", 0, 0, reinterpret_cast<struct sockaddr*>(&remote), sizeof(remote));
+            close(probe);
+        }
+        
+        for (int attempt = 0; attempt < 10 && !resolved; ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            resolved = lookup_neighbour();
+        }
+    }
+    
+    if (!resolved) {
+        throw std::runtime_error("Cannot resolve next-hop MAC address for " + target);
+    }
+    return link;
+}
+
 std::string NetworkUtils::get_service_name(Port port, const std::string& protocol) {
     struct servent* service = getservbyport(htons(port), protocol.c_str());
     if (service != nullptr) {
@@ -106,6 +336,15 @@ int NetworkUtils::create_raw_socket() {
     return sockfd;
 }
 
+int NetworkUtils::create_packet_socket() {
+    // Cooked mode: the link-layer header is stripped, packets start at IP
+    int sockfd = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    if (sockfd < 0) {
+        throw std::runtime_error("Failed to create packet socket (requires root): " + std::string(strerror(errno)));
+    }
+    return sockfd;
+}
+
 bool NetworkUtils::set_socket_timeout(int sockfd, Duration timeout) {
     struct timeval tv;
     tv.tv_sec = timeout.count() / 1000;
@@ -140,4 +379,156 @@ std::string NetworkUtils::sockaddr_to_string(const sockaddr_in& addr) {
     return std::string(ip_str) + ":" + std::to_string(ntohs(addr.sin_port));
 }
 
+namespace {
+    // Kernels sum native-order 32-bit words into 64-bit lanes: 2^16 = 1
+    // modulo 0xffff, so after folding this equals the RFC 1071 sum of 16-bit words
+    using ChecksumKernel = NetworkUtils::ChecksumKernel;
+    
+    std::uint64_t sum_scalar(const std::uint8_t* bytes, std::size_t length) {
+        std::uint64_t sum = 0;
+        
+        while (length >= 4) {
+            std::uint32_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            sum += word;
+            bytes += 4;
+            length -= 4;
+        }
+        
+        if (length >= 2) {
+            std::uint16_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            sum += word;
+            bytes += 2;
+            length -= 2;
+        }
+        
+        if (length > 0) {
+            std::uint16_t word = 0;
+            std::memcpy(&word, bytes, 1);
+            sum += word;
+        }
+        
+        return sum;
+    }
+    
+#if defined(__x86_64__) || defined(__i386__)
+    __attribute__((target("sse2")))
+    std::uint64_t sum_sse2(const std::uint8_t* bytes, std::size_t length) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum_a = zero;
+        __m128i sum_b = zero;
+        
+        // Widen each 32-bit word to 64 bits, so the lanes never overflow
+        while (length >= 32) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 16));
+            sum_a = _mm_add_epi64(sum_a, _mm_unpacklo_epi32(a, zero));
+            sum_a = _mm_add_epi64(sum_a, _mm_unpackhi_epi32(a, zero));
+            sum_b = _mm_add_epi64(sum_b, _mm_unpacklo_epi32(b, zero));
+            sum_b = _mm_add_epi64(sum_b, _mm_unpackhi_epi32(b, zero));
+            bytes += 32;
+            length -= 32;
+        }
+        
+        alignas(16) std::uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(sum_a, sum_b));
+        
+        // Each lane sums under 2^30 words of 32 bits, so adding them cannot wrap
+        return lanes[0] + lanes[1] + sum_scalar(bytes, length);
+    }
+    
+    __attribute__((target("avx2")))
+    std::uint64_t sum_avx2(const std::uint8_t* bytes, std::size_t length) {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i sum_a = zero;
+        __m256i sum_b = zero;
+        
+        while (length >= 64) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + 32));
+            sum_a = _mm256_add_epi64(sum_a, _mm256_unpacklo_epi32(a, zero));
+            sum_a = _mm256_add_epi64(sum_a, _mm256_unpackhi_epi32(a, zero));
+            sum_b = _mm256_add_epi64(sum_b, _mm256_unpacklo_epi32(b, zero));
+            sum_b = _mm256_add_epi64(sum_b, _mm256_unpackhi_epi32(b, zero));
+            bytes += 64;
+            length -= 64;
+        }
+        
+        alignas(32) std::uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(sum_a, sum_b));
+        
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_sse2(bytes, length);
+    }
+#endif
+    
+    ChecksumKernel select_checksum_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return sum_avx2;
+        if (__builtin_cpu_supports("sse2")) return sum_sse2;
+#endif
+        return sum_scalar;
+    }
+    
+    // Headers are too short for the vector setup to pay off
+    constexpr std::size_t VECTOR_THRESHOLD = 128;
+    
+    const ChecksumKernel checksum_kernel = select_checksum_kernel();
+}
+
+std::uint16_t NetworkUtils::checksum(const void* data, std::size_t length, std::uint32_t initial) {
+    // The one's complement sum is byte-order independent, so the folded
+    // result can be stored back as-is
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    std::uint64_t sum = initial;
+    
+    sum += length < VECTOR_THRESHOLD ? sum_scalar(bytes, length) : checksum_kernel(bytes, length);
+    
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    
+    return static_cast<std::uint16_t>(~sum);
+}
+
+std::vector<std::pair<std::string, NetworkUtils::ChecksumKernel>> NetworkUtils::checksum_kernels() {
+    std::vector<std::pair<std::string, ChecksumKernel>> kernels{{"scalar", sum_scalar}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) kernels.emplace_back("sse2", sum_sse2);
+    if (__builtin_cpu_supports("avx2")) kernels.emplace_back("avx2", sum_avx2);
+#endif
+    return kernels;
+}
+
+std::uint16_t NetworkUtils::transport_checksum(in_addr_t source, in_addr_t destination, std::uint8_t protocol,
+                                               const void* segment, std::size_t length) {
+    // IPv4 pseudo header: addresses, protocol and segment length
+    struct {
+        in_addr_t source;
+        in_addr_t destination;
+        std::uint8_t zero;
+        std::uint8_t protocol;
+        std::uint16_t length;
+    } __attribute__((packed)) pseudo{source, destination, 0, protocol,
+                                     htons(static_cast<std::uint16_t>(length))};
+    
+    std::uint16_t pseudo_sum = static_cast<std::uint16_t>(~checksum(&pseudo, sizeof(pseudo)));
+    return checksum(segment, length, pseudo_sum);
+}
+
+std::uint16_t NetworkUtils::checksum_adjust(std::uint16_t check, std::uint32_t old_value, std::uint32_t new_value) {
+    // HC' = ~(~HC + ~m + m'), applied to both 16-bit halves of the field
+    std::uint32_t sum = static_cast<std::uint16_t>(~check);
+    sum += static_cast<std::uint16_t>(~old_value) + static_cast<std::uint16_t>(~(old_value >> 16));
+    sum += static_cast<std::uint16_t>(new_value) + static_cast<std::uint16_t>(new_value >> 16);
+    
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    
+    return static_cast<std::uint16_t>(~sum);
+}
+
 } // namespace PortScanner
\ No newline at end of file
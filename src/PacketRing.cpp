@@ -0,0 +1,240 @@
+#include "PacketRing.h"
+#include "NetworkUtils.h"
+#include <linux/if_packet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace PortScanner {
+
+PacketRing::PacketRing(in_addr_t network, in_addr_t netmask) {
+    fd_ = NetworkUtils::create_packet_socket();
+    
+    try {
+        int version = TPACKET_V3;
+        if (setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+            throw std::runtime_error("Failed to select TPACKET_V3: " + std::string(strerror(errno)));
+        }
+        
+        // Filter before the ring is mapped so unrelated traffic never fills it
+        attach_filter(network, netmask);
+        
+        tpacket_req3 request{};
+        request.tp_block_size = RING_BLOCK_SIZE;
+        request.tp_block_nr = RING_BLOCK_COUNT;
+        request.tp_frame_size = RING_FRAME_SIZE;
+        request.tp_frame_nr = (RING_BLOCK_SIZE / RING_FRAME_SIZE) * RING_BLOCK_COUNT;
+        request.tp_retire_blk_tov = BLOCK_TIMEOUT_MS;
+        
+        if (setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &request, sizeof(request)) < 0) {
+            throw std::runtime_error("Failed to set up PACKET_RX_RING: " + std::string(strerror(errno)));
+        }
+        
+        ring_size_ = static_cast<std::size_t>(RING_BLOCK_SIZE) * RING_BLOCK_COUNT;
+        void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd_, 0);
+        if (ring == MAP_FAILED) {
+            // MAP_LOCKED can exceed RLIMIT_MEMLOCK; the ring works unlocked too
+            ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        }
+        if (ring == MAP_FAILED) {
+            throw std::runtime_error("Failed to map packet ring: " + std::string(strerror(errno)));
+        }
+        ring_ = static_cast<std::uint8_t*>(ring);
+    
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+PacketRing::~PacketRing() {
+    release();
+}
+
+std::size_t PacketRing::receive(int timeout_ms, const PacketHandler& handler) {
+    auto block_at = [this](unsigned index) {
+        return reinterpret_cast<tpacket_block_desc*>(ring_ + static_cast<std::size_t>(index) * RING_BLOCK_SIZE);
+    };
+    
+    tpacket_block_desc* block = block_at(current_block_);
+    if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+        pollfd pfd{fd_, POLLIN | POLLERR, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0) return 0;
+    }
+    
+    std::size_t packets = 0;
+    
+    // Consume every block the kernel has retired, in ring order
+    while (__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) {
+        const std::uint32_t count = block->hdr.bh1.num_pkts;
+        auto* frame = reinterpret_cast<std::uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt;
+        
+        for (std::uint32_t i = 0; i < count; ++i) {
+            const auto* header = reinterpret_cast<const tpacket3_hdr*>(frame);
+            const auto* link = reinterpret_cast<const sockaddr_ll*>(frame + TPACKET_ALIGN(sizeof(tpacket3_hdr)));
+            
+            // Our own probes show up as outgoing copies on loopback
+            if (link->sll_pkttype != PACKET_OUTGOING) {
+                handler(frame + header->tp_net, header->tp_snaplen);
+                ++packets;
+            }
+            
+            frame += header->tp_next_offset;
+        }
+        
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        current_block_ = (current_block_ + 1) % RING_BLOCK_COUNT;
+        block = block_at(current_block_);
+    }
+    
+    return packets;
+}
+
+void PacketRing::attach_filter(in_addr_t network, in_addr_t netmask) {
+    // Cooked (SOCK_DGRAM) packets start at the IP header: accept
+    // "icmp or src net <network>", since unreachables may come from any router
+    sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 9),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_ICMP, 3, 0),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 12),
+        BPF_STMT(BPF_ALU | BPF_AND | BPF_K, ntohl(netmask)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ntohl(network), 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 0xffff),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    sock_fprog program{static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+    
+    if (setsockopt(fd_, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0) {
+        throw std::runtime_error("Failed to attach packet filter: " + std::string(strerror(errno)));
+    }
+}
+
+PacketTxRing::PacketTxRing(const LinkAddress& link) : link_(link) {
+    fd_ = NetworkUtils::create_packet_socket();
+    
+    try {
+        int version = TPACKET_V2;
+        if (setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+            throw std::runtime_error("Failed to select TPACKET_V2: " + std::string(strerror(errno)));
+        }
+        
+        tpacket_req request{};
+        request.tp_block_size = RING_BLOCK_SIZE;
+        request.tp_block_nr = RING_BLOCK_COUNT;
+        request.tp_frame_size = RING_FRAME_SIZE;
+        request.tp_frame_nr = FRAME_COUNT;
+        
+        if (setsockopt(fd_, SOL_PACKET, PACKET_TX_RING, &request, sizeof(request)) < 0) {
+            throw std::runtime_error("Failed to set up PACKET_TX_RING: " + std::string(strerror(errno)));
+        }
+        
+        // Only transmit: a zero protocol keeps inbound traffic off this socket
+        sockaddr_ll local{};
+        local.sll_family = AF_PACKET;
+        local.sll_protocol = 0;
+        local.sll_ifindex = link_.ifindex;
+        if (bind(fd_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+            throw std::runtime_error("Failed to bind packet socket: " + std::string(strerror(errno)));
+        }
+        
+        ring_size_ = static_cast<std::size_t>(RING_BLOCK_SIZE) * RING_BLOCK_COUNT;
+        void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (ring == MAP_FAILED) {
+            throw std::runtime_error("Failed to map packet ring: " + std::string(strerror(errno)));
+        }
+        ring_ = static_cast<std::uint8_t*>(ring);
+        
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+PacketTxRing::~PacketTxRing() {
+    if (ring_) {
+        flush();
+    }
+    release();
+}
+
+std::uint8_t* PacketTxRing::acquire() {
+    auto* header = reinterpret_cast<tpacket2_hdr*>(ring_ + static_cast<std::size_t>(current_frame_) * RING_FRAME_SIZE);
+    
+    // A frame the kernel rejected is simply reused
+    const std::uint32_t status = __atomic_load_n(&header->tp_status, __ATOMIC_ACQUIRE);
+    if (status != TP_STATUS_AVAILABLE && status != TP_STATUS_WRONG_FORMAT) {
+        return nullptr;
+    }
+    
+    return reinterpret_cast<std::uint8_t*>(header) + TPACKET_ALIGN(sizeof(tpacket2_hdr));
+}
+
+std::size_t PacketTxRing::frame_capacity() const noexcept {
+    return RING_FRAME_SIZE - TPACKET_ALIGN(sizeof(tpacket2_hdr));
+}
+
+void PacketTxRing::commit(std::size_t length) {
+    auto* header = reinterpret_cast<tpacket2_hdr*>(ring_ + static_cast<std::size_t>(current_frame_) * RING_FRAME_SIZE);
+    header->tp_len = static_cast<std::uint32_t>(length);
+    __atomic_store_n(&header->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+    
+    current_frame_ = (current_frame_ + 1) % FRAME_COUNT;
+    if (++queued_ >= BATCH_SIZE) {
+        flush();
+    }
+}
+
+void PacketTxRing::flush() {
+    if (queued_ == 0) return;
+    
+    // Cooked socket: the kernel adds the link header for this next hop
+    sockaddr_ll destination{};
+    destination.sll_family = AF_PACKET;
+    destination.sll_protocol = htons(ETH_P_IP);
+    destination.sll_ifindex = link_.ifindex;
+    destination.sll_halen = sizeof(link_.mac);
+    std::memcpy(destination.sll_addr, link_.mac, sizeof(link_.mac));
+    
+    while (sendto(fd_, nullptr, 0, 0, reinterpret_cast<sockaddr*>(&destination), sizeof(destination)) < 0) {
+        if (errno != EINTR && errno != ENOBUFS && errno != EAGAIN) break;
+    }
+    queued_ = 0;
+}
+
+void PacketTxRing::wait(int timeout_ms) {
+    flush();
+    
+    pollfd pfd{fd_, POLLOUT, 0};
+    poll(&pfd, 1, timeout_ms);
+}
+
+void PacketTxRing::release() {
+    if (ring_) {
+        munmap(ring_, ring_size_);
+        ring_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void PacketRing::release() {
+    if (ring_) {
+        munmap(ring_, ring_size_);
+        ring_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+} // namespace PortScanner
\ No newline at end of file
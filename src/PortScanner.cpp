@@ -12,6 +12,7 @@
 #include <unistd.h>
 #include <poll.h>
 #include <cstring>
+#include <random>
 
 namespace PortScanner {
 
@@ -20,7 +21,23 @@ PortScanner::PortScanner(const ScanConfig& config) : config_(config) {
 }
 
 void PortScanner::init_components() {
+    // Configs built in code may only carry the target string
+    if (config_.targets.empty()) {
+        config_.targets = NetworkUtils::expand_targets(config_.target);
+    }
+    
+    // Pick the probe order key once, so every engine and pass shares it
+    // and it can be reported to reproduce the scan
+    if (config_.randomize && config_.seed == 0) {
+        std::random_device device;
+        config_.seed = (std::uint64_t{device()} << 32) | device();
+    }
+    
     service_detector_ = std::make_unique<ServiceDetector>();
+    rtt_.clear();
+    for (std::size_t i = 0; i < config_.targets.size(); ++i) {
+        rtt_.emplace_back(config_);
+    }
     
     if (high_performance_mode_) {
         async_scanner_ = std::make_unique<AsyncScanner>(config_);
@@ -28,50 +45,211 @@ void PortScanner::init_components() {
 }
 
 ScanResults PortScanner::scan_ports(ProgressCallback progress_cb) {
-    if (high_performance_mode_ && async_scanner_) {
+    cancelled_.store(false);
+    
+    // Engines report each final result to the checkpoint and the stream as
+    // it comes in; each has its own thread for the disk. A resumed scan's
+    // stream starts over with what the checkpoint had, so it ends up with
+    // every result once, as if the scan had never been interrupted
+    sinks_.clear();
+    checkpoint_.reset();
+    stream_.reset();
+    stream_lines_ = 0;
+    if (config_.stream) {
+        stream_ = std::make_unique<ResultStream>(config_.output_file);
+        stream_->write(resumed_);
+        sinks_.add(stream_.get());
+    }
+    
+    // Dead hosts never reach the engines, nor the checkpoint's target list
+    if (config_.discover) {
+        discover_hosts();
+        if (cancelled_.load() || config_.targets.empty()) {
+            sinks_.clear();
+            stream_.reset();
+            return ScanResults{};
+        }
+    }
+    
+    if (!config_.checkpoint_file.empty()) {
+        checkpoint_ = std::make_unique<Checkpoint>(config_, resumed_);
+        sinks_.add(checkpoint_.get());
+    }
+    if (async_scanner_) {
+        async_scanner_->set_sink(sink());
+    }
+    
+    ScanResults results = run_engines(progress_cb);
+    
+    ScanResults carried = resumed_;
+    results.merge(std::move(carried));
+    
+    if (async_scanner_) {
+        async_scanner_->set_sink(nullptr);
+    }
+    sinks_.clear();
+    if (stream_) {
+        stream_lines_ = stream_->lines();
+        const bool written = stream_->close();
+        stream_.reset();
+        if (!written) {
+            throw std::runtime_error("Error writing stream output file: " + config_.output_file);
+        }
+    }
+    
+    // Interrupted: keep what is pending for --resume; done: nothing is. A
+    // streamed scan's results lack the rows it did not keep, but everything
+    // was recorded as it came in
+    if (checkpoint_) {
+        if (cancelled_.load() || config_.stream) {
+            checkpoint_->save();
+        } else {
+            checkpoint_->save_complete(results);
+        }
+        checkpoint_.reset();
+    }
+    
+    return results;
+}
+
+void PortScanner::discover_hosts() {
+    {
+        std::lock_guard<std::mutex> lock(engine_mutex_);
+        discovery_ = std::make_unique<HostDiscovery>(config_);
+    }
+    
+    const std::vector<std::uint32_t> live = discovery_->run();
+    discovery_stats_ = discovery_->stats();
+    
+    std::vector<IPAddress> targets;
+    targets.reserve(live.size());
+    for (std::uint32_t host : live) {
+        targets.push_back(config_.targets[host]);
+    }
+    
+    // From here on the scan is an ordinary one over the live hosts; per-target
+    // state and the async engine are rebuilt for the shorter list
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    discovery_.reset();
+    config_.targets = std::move(targets);
+    config_.discover = false;
+    if (!config_.targets.empty()) {
+        init_components();
+    }
+}
+
+ScanResults PortScanner::run_engines(ProgressCallback progress_cb) {
+    // Raw probes go out in one pass from a dedicated send/receive engine
+    if (uses_raw_engine()) {
+        ScanResults results;
+        if (run_raw_scan(results, progress_cb)) {
+            return results;
+        }
+        
+        // No raw socket privileges: a SYN scan degrades to connect scanning
+        // below, but the other probes have no unprivileged equivalent
+        if (config_.scan_type != ScanType::TCP_SYN) {
+            throw std::runtime_error(ConfigManager::scan_type_to_string(config_.scan_type) +
+                                     " scan requires raw sockets (run as root)");
+        }
+    }
+    
+    // UDP probes are batched over a few sockets instead of one per port
+    if (uses_udp_engine()) {
+        ScanResults results;
+        if (run_udp_scan(results, progress_cb)) {
+            return results;
+        }
+    }
+    
+    if (high_performance_mode_ && async_scanner_ && !uses_raw_engine() && !uses_udp_engine()) {
         auto future_result = async_scanner_->scan_async(progress_cb);
         return future_result.get();
     }
     
     // Fallback to traditional multi-threaded scanning
-    ScanResults results;
-    std::mutex results_mutex;
     std::atomic<std::size_t> completed{0};
+    auto limiter = RateLimiter::from_config(config_);
+    ScanResults results = run_threaded_pass(ProbeSpace(config_), progress_cb, completed, limiter.get(),
+                                            config_.max_retries == 0);
+    
+    // Same retry policy as the async engine: re-probe timed-out ports only
+    for (std::size_t retry = 0; retry < config_.max_retries && !cancelled_.load(); ++retry) {
+        ProbeSpace pending = ProbeSpace::from_results(results.extract(PortStatus::FILTERED), config_.targets);
+        if (pending.size() == 0) break;
+        
+        completed.fetch_sub(pending.size());
+        std::this_thread::sleep_for(config_.retry_delay);
+        results.merge(run_threaded_pass(pending, progress_cb, completed, limiter.get(),
+                                        retry + 1 == config_.max_retries));
+    }
+    
+    return results;
+}
+
+ScanResults PortScanner::run_threaded_pass(const ProbeSpace& probes, const ProgressCallback& progress_cb,
+                                           std::atomic<std::size_t>& completed, RateLimiter* limiter,
+                                           bool final_pass) {
+    ScanResults results = ScanResults::for_config(config_);
+    std::mutex results_mutex;
     
-    const std::size_t thread_count = std::min(config_.thread_count, config_.ports.size());
-    const std::size_t ports_per_thread = (config_.ports.size() + thread_count - 1) / thread_count;
+    const std::size_t total = probe_count(config_);
+    const std::size_t thread_count = std::min(config_.thread_count, probes.size());
+    const std::size_t probes_per_thread = (probes.size() + thread_count - 1) / thread_count;
     
     std::vector<std::thread> threads;
     threads.reserve(thread_count);
     
     for (std::size_t i = 0; i < thread_count; ++i) {
-        std::size_t start_idx = i * ports_per_thread;
-        std::size_t end_idx = std::min(start_idx + ports_per_thread, config_.ports.size());
+        std::size_t start_idx = i * probes_per_thread;
+        std::size_t end_idx = std::min(start_idx + probes_per_thread, probes.size());
         
-        if (start_idx >= config_.ports.size()) break;
+        if (start_idx >= probes.size()) break;
         
-        threads.emplace_back([this, &results, &results_mutex, &completed, 
-                            start_idx, end_idx, progress_cb]() {
+        threads.emplace_back([this, &probes, &results, &results_mutex, &completed, limiter,
+                            start_idx, end_idx, total, &progress_cb, final_pass]() {
             
             for (std::size_t idx = start_idx; idx < end_idx; ++idx) {
+                if (cancelled_.load()) break;
+                if (limiter && !limiter->acquire(cancelled_)) break;
+                
+                const ProbeTarget probe = probes[idx];
+                ScanResult result;
                 try {
-                    ScanResult result = scan_single_port(config_.ports[idx], config_.scan_type);
-                    
-                    {
-                        std::lock_guard<std::mutex> lock(results_mutex);
-                        results.add_result(result);
-                    }
+                    result = scan_probe(probe, config_.scan_type);
                     
-                    std::size_t current_completed = completed.fetch_add(1) + 1;
-                    
-                    if (progress_cb) {
-                        progress_cb(current_completed, config_.ports.size());
+                    if (limiter) {
+                        if (result.status == PortStatus::FILTERED) {
+                            limiter->on_loss();
+                        } else {
+                            limiter->on_reply();
+                        }
                     }
                     
                 } catch (const std::exception&) {
+                    // The probe itself failed (no socket, bad address): a
+                    // final UNKNOWN, reported like any other result
+                    result = ScanResult{};
+                    result.host = config_.targets[probe.host];
+                    result.port = probe.port;
+                    result.status = PortStatus::UNKNOWN;
+                    result.ip_version = is_ipv6_address(result.host) ? IPVersion::IPv6 : IPVersion::IPv4;
+                }
+                
+                if (!sinks_.empty() && !cancelled_.load() &&
+                    (result.status != PortStatus::FILTERED || final_pass)) {
+                    sinks_.record(probe, result);
+                }
+                
+                {
                     std::lock_guard<std::mutex> lock(results_mutex);
-                    results.add_result(config_.ports[idx], PortStatus::UNKNOWN);
-                    completed.fetch_add(1);
+                    results.add_result(result);
+                }
+                
+                std::size_t current_completed = completed.fetch_add(1) + 1;
+                
+                if (progress_cb) {
+                    progress_cb(current_completed, total);
                 }
             }
         });
@@ -87,27 +265,30 @@ ScanResults PortScanner::scan_ports(ProgressCallback progress_cb) {
 }
 
 std::future<ScanResults> PortScanner::scan_ports_async(ProgressCallback progress_cb) {
-    if (high_performance_mode_ && async_scanner_) {
-        return async_scanner_->scan_async(progress_cb);
-    }
-    
     return std::async(std::launch::async, [this, progress_cb]() {
         return scan_ports(progress_cb);
     });
 }
 
 ScanResult PortScanner::scan_single_port(Port port, ScanType scan_type) {
+    return scan_probe(ProbeTarget{0, port}, scan_type);
+}
+
+ScanResult PortScanner::scan_probe(const ProbeTarget& probe, ScanType scan_type) {
     switch (scan_type) {
         case ScanType::TCP_CONNECT:
-            return tcp_connect_scan(port);
+            return tcp_connect_scan(probe);
         case ScanType::TCP_SYN:
-            return tcp_syn_scan(port);
+            return tcp_syn_scan(probe);
         case ScanType::UDP:
-            return udp_scan(port);
+            return udp_scan(probe);
         case ScanType::TCP_ACK:
-            return tcp_ack_scan(port);
+            return tcp_ack_scan(probe);
         case ScanType::TCP_FIN:
-            return tcp_fin_scan(port);
+            return tcp_fin_scan(probe);
+        case ScanType::TCP_NULL:
+        case ScanType::TCP_XMAS:
+            return raw_probe_scan(probe, scan_type);
         default:
             throw std::runtime_error("Unsupported scan type");
     }
@@ -128,117 +309,184 @@ bool PortScanner::is_ipv6_address(const IPAddress& ip) {
 }
 
 void PortScanner::cancel_scan() {
+    cancelled_.store(true);
+    
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    if (discovery_) {
+        discovery_->cancel();
+    }
+    
     if (async_scanner_) {
         async_scanner_->cancel();
     }
+    
+    if (raw_scanner_) {
+        raw_scanner_->cancel();
+    }
+    
+    if (udp_scanner_) {
+        udp_scanner_->cancel();
+    }
+}
+
+PacketStats PortScanner::packet_stats() const {
+    return raw_scanner_ ? raw_scanner_->stats() : PacketStats{};
+}
+
+bool PortScanner::uses_raw_engine() const {
+    switch (config_.scan_type) {
+        case ScanType::TCP_SYN:
+        case ScanType::TCP_ACK:
+        case ScanType::TCP_FIN:
+        case ScanType::TCP_NULL:
+        case ScanType::TCP_XMAS:
+            return true;
+        default:
+            return false;
+    }
 }
 
-ScanResult PortScanner::tcp_connect_scan(Port port) {
+bool PortScanner::run_raw_scan(ScanResults& results, ProgressCallback progress_cb) {
+    {
+        std::lock_guard<std::mutex> lock(engine_mutex_);
+        try {
+            raw_scanner_ = std::make_unique<RawScanner>(config_);
+        } catch (const std::exception&) {
+            return false;
+        }
+        raw_scanner_->set_sink(sink());
+    }
+    
+    results = raw_scanner_->scan(progress_cb);
+    raw_scanner_->set_sink(nullptr);
+    return true;
+}
+
+bool PortScanner::uses_udp_engine() const {
+    return config_.scan_type == ScanType::UDP;
+}
+
+bool PortScanner::run_udp_scan(ScanResults& results, ProgressCallback progress_cb) {
+    {
+        std::lock_guard<std::mutex> lock(engine_mutex_);
+        try {
+            udp_scanner_ = std::make_unique<UdpScanner>(config_);
+        } catch (const std::exception&) {
+            return false;
+        }
+        udp_scanner_->set_sink(sink());
+    }
+    
+    results = udp_scanner_->scan(progress_cb);
+    udp_scanner_->set_sink(nullptr);
+    return true;
+}
+
+ScanResult PortScanner::tcp_connect_scan(const ProbeTarget& probe) {
+    const IPAddress& host = config_.targets[probe.host];
+    RttEstimator& rtt = rtt_[probe.host];
     auto start_time = std::chrono::steady_clock::now();
     
     int sockfd = NetworkUtils::create_tcp_socket();
-    NetworkUtils::set_socket_timeout(sockfd, config_.timeout);
+    NetworkUtils::set_socket_timeout(sockfd, rtt.timeout_ms());
     
-    sockaddr_in target_addr = NetworkUtils::create_sockaddr(config_.target, port);
+    // Retries are ours: one kernel SYN retransmission at most (the minimum)
+    if (config_.max_retries > 0) {
+        int syn_count = 1;
+        setsockopt(sockfd, IPPROTO_TCP, TCP_SYNCNT, &syn_count, sizeof(syn_count));
+    }
+    
+    sockaddr_in target_addr = NetworkUtils::create_sockaddr(host, probe.port);
     
     int result = connect(sockfd, reinterpret_cast<struct sockaddr*>(&target_addr), sizeof(target_addr));
+    const int error = result == 0 ? 0 : errno;
     
     auto end_time = std::chrono::steady_clock::now();
     auto response_time = std::chrono::duration_cast<Duration>(end_time - start_time);
     
+    // Accepted or refused, the target answered: a round-trip sample
+    if (result == 0 || error == ECONNREFUSED) {
+        rtt.add_sample(end_time - start_time);
+    }
+    
     close(sockfd);
     
+    // A connect cut off by the send timeout never got an answer
+    PortStatus status = PortStatus::CLOSED;
+    if (result == 0) {
+        status = PortStatus::OPEN;
+    } else if (error == EINPROGRESS || error == EAGAIN || error == ETIMEDOUT) {
+        status = PortStatus::FILTERED;
+    }
+    
     ScanResult scan_result;
-    scan_result.port = port;
-    scan_result.status = (result == 0) ? PortStatus::OPEN : PortStatus::CLOSED;
+    scan_result.host = host;
+    scan_result.port = probe.port;
+    scan_result.status = status;
     scan_result.response_time = response_time;
-    scan_result.ip_version = is_ipv6_address(config_.target) ? IPVersion::IPv6 : IPVersion::IPv4;
+    scan_result.ip_version = is_ipv6_address(host) ? IPVersion::IPv6 : IPVersion::IPv4;
     
     // Enhanced service detection
     if (scan_result.status == PortStatus::OPEN && config_.service_detection && service_detector_) {
-        scan_result.service = service_detector_->detect_service(config_.target, port);
+        scan_result.service = service_detector_->detect_service(host, probe.port);
         
         if (config_.banner_grabbing) {
-            scan_result.banner = service_detector_->grab_banner(config_.target, port, Duration{2000});
+            scan_result.banner = service_detector_->grab_banner(host, probe.port, Duration{2000});
         }
     }
     
     return scan_result;
 }
 
-ScanResult PortScanner::tcp_syn_scan(Port port) {
+ScanResult PortScanner::tcp_syn_scan(const ProbeTarget& probe) {
     try {
-        int sockfd = NetworkUtils::create_raw_socket();
-        close(sockfd);
-        
-        // For now, fallback to connect scan
-        return tcp_connect_scan(port);
-        
+        return raw_probe_scan(probe, ScanType::TCP_SYN);
     } catch (const std::exception&) {
-        return tcp_connect_scan(port);
+        // Raw sockets need root: fall back to a full connect
     }
+    
+    return tcp_connect_scan(probe);
 }
 
-ScanResult PortScanner::udp_scan(Port port) {
-    auto start_time = std::chrono::steady_clock::now();
-    
-    int sockfd = NetworkUtils::create_udp_socket();
-    NetworkUtils::set_socket_timeout(sockfd, config_.timeout);
-    
-    sockaddr_in target_addr = NetworkUtils::create_sockaddr(config_.target, port);
-    
-    const char* test_data = "test";
-    ssize_t sent = sendto(sockfd, test_data, strlen(test_data), 0,
-                         reinterpret_cast<struct sockaddr*>(&target_addr), sizeof(target_addr));
-    
-    PortStatus status = PortStatus::UNKNOWN;
-    
-    if (sent > 0) {
-        char buffer[1024];
-        struct pollfd pfd;
-        pfd.fd = sockfd;
-        pfd.events = POLLIN;
-        
-        int poll_result = poll(&pfd, 1, config_.timeout.count());
-        
-        if (poll_result > 0) {
-            recv(sockfd, buffer, sizeof(buffer), 0);
-            status = PortStatus::OPEN;
-        } else if (poll_result == 0) {
-            status = PortStatus::FILTERED;
-        } else {
-            status = PortStatus::CLOSED;
-        }
-    }
-    
-    auto end_time = std::chrono::steady_clock::now();
-    auto response_time = std::chrono::duration_cast<Duration>(end_time - start_time);
+ScanResult PortScanner::raw_probe_scan(const ProbeTarget& probe, ScanType scan_type) {
+    ScanConfig single_port_config = single_probe_config(probe);
+    single_port_config.scan_type = scan_type;
     
-    close(sockfd);
-    
-    ScanResult scan_result;
-    scan_result.port = port;
-    scan_result.status = status;
-    scan_result.response_time = response_time;
-    scan_result.ip_version = is_ipv6_address(config_.target) ? IPVersion::IPv6 : IPVersion::IPv4;
+    RawScanner raw_scanner(single_port_config);
+    ScanResults results = raw_scanner.scan();
     
-    if (status == PortStatus::OPEN && config_.service_detection && service_detector_) {
-        scan_result.service = service_detector_->detect_service(config_.target, port);
-    }
+    return results.get_results().front();
+}
+
+ScanResult PortScanner::udp_scan(const ProbeTarget& probe) {
+    // One-port run of the batched engine, so ICMP port unreachable is seen
+    UdpScanner udp_scanner(single_probe_config(probe));
+    ScanResults results = udp_scanner.scan();
     
-    return scan_result;
+    return results.get_results().front();
+}
+
+ScanResult PortScanner::tcp_ack_scan(const ProbeTarget& probe) {
+    return raw_probe_scan(probe, ScanType::TCP_ACK);
 }
 
-ScanResult PortScanner::tcp_ack_scan(Port port) {
-    // ACK scan implementation would require raw sockets
-    // For now, fallback to connect scan
-    return tcp_connect_scan(port);
+ScanResult PortScanner::tcp_fin_scan(const ProbeTarget& probe) {
+    return raw_probe_scan(probe, ScanType::TCP_FIN);
 }
 
-ScanResult PortScanner::tcp_fin_scan(Port port) {
-    // FIN scan implementation would require raw sockets
-    // For now, fallback to connect scan
-    return tcp_connect_scan(port);
+ScanConfig PortScanner::single_probe_config(const ProbeTarget& probe) const {
+    ScanConfig single_probe = config_;
+    single_probe.target = config_.targets[probe.host];
+    single_probe.targets = {single_probe.target};
+    single_probe.ports = {probe.port};
+    
+    // The one probe is the whole pass: no shard, resume or checkpoint applies
+    single_probe.shard_index = 0;
+    single_probe.shard_count = 1;
+    single_probe.pending.clear();
+    single_probe.checkpoint_file.clear();
+    single_probe.stream = false;
+    return single_probe;
 }
 
 bool PortScanner::is_valid_ip(const IPAddress& ip) {
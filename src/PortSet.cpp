@@ -0,0 +1,261 @@
+#include "PortSet.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace PortScanner {
+
+namespace {
+    // TCP ports by how often they are found open on the Internet (nmap's
+    // frequency table), most common first
+    constexpr Port TOP_PORTS[] = {
+        80, 23, 443, 21, 22, 25, 3389, 110, 445, 139, 143, 53, 135, 3306, 8080, 1723, 111, 995, 993, 5900,
+        1025, 587, 8888, 199, 1720, 465, 548, 113, 81, 6001, 10000, 514, 5060, 179, 1026, 2000, 8443, 8000,
+        32768, 554, 26, 1433, 49152, 2001, 515, 8008, 49154, 1027, 5666, 646, 5000, 5631, 631, 49153, 8081,
+        2049, 88, 79, 5800, 106, 2121, 1110, 49155, 6000, 513, 990, 5357, 427, 49156, 543, 544, 5101, 144, 7,
+        389, 8009, 3128, 444, 9999, 5009, 7070, 5190, 3000, 5432, 1900, 3986, 13, 1029, 9, 5051, 6646, 49157,
+        1028, 873, 1755, 2717, 4899, 9100, 119, 37
+    };
+    
+    void skip_spaces(const std::string& spec, std::size_t& position, std::size_t end) {
+        while (position < end && std::isspace(static_cast<unsigned char>(spec[position]))) {
+            ++position;
+        }
+    }
+    
+    // Decimal number at position, -1 if there is none; saturates above the
+    // port range so that a long digit string cannot overflow
+    long read_number(const std::string& spec, std::size_t& position, std::size_t end) {
+        skip_spaces(spec, position, end);
+        long value = -1;
+        while (position < end && std::isdigit(static_cast<unsigned char>(spec[position]))) {
+            value = std::min<long>((value < 0 ? 0 : value * 10) + (spec[position] - '0'), 1000000);
+            ++position;
+        }
+        return value;
+    }
+}
+
+PortSet::const_iterator::const_iterator(const PortSet* set, std::size_t word)
+    : set_(set), word_(set->empty() ? WORDS : word), bits_(set->empty() ? 0 : set->word(word)) {
+    skip_empty();
+}
+
+void PortSet::const_iterator::skip_empty() {
+    while (bits_ == 0 && word_ < WORDS) {
+        if (++word_ < WORDS) {
+            bits_ = set_->word(word_);
+        }
+    }
+}
+
+PortSet::PortSet(std::initializer_list<Port> ports) {
+    for (Port port : ports) {
+        insert(port);
+    }
+}
+
+PortSet PortSet::parse(const std::string& spec) {
+    PortSet ports;
+    std::size_t position = 0;
+    
+    while (position <= spec.size()) {
+        std::size_t end = spec.find(',', position);
+        if (end == std::string::npos) end = spec.size();
+        const std::string token = spec.substr(position, end - position);
+        
+        // Empty items (a trailing comma) are skipped
+        skip_spaces(spec, position, end);
+        if (position < end) {
+            long first = read_number(spec, position, end);
+            long last = first;
+            
+            skip_spaces(spec, position, end);
+            if (position < end && spec[position] == '-') {
+                ++position;
+                last = read_number(spec, position, end);
+                if (first < 0) first = 1;
+                if (last < 0) last = 65535;
+            }
+            
+            skip_spaces(spec, position, end);
+            if (first < 0 || position != end) {
+                throw std::runtime_error("Invalid port specification: " + token);
+            }
+            if (first > last) {
+                std::swap(first, last);
+            }
+            if (first < 1 || last > 65535) {
+                throw std::runtime_error("Port " + std::to_string(first < 1 ? first : last) + " is out of valid range");
+            }
+            
+            ports.insert_range(static_cast<Port>(first), static_cast<Port>(last));
+        }
+        
+        position = end + 1;
+    }
+    
+    return ports;
+}
+
+PortSet PortSet::top(std::size_t n) {
+    PortSet ports;
+    for (std::size_t i = 0; i < std::min(n, top_count()); ++i) {
+        ports.insert(TOP_PORTS[i]);
+    }
+    return ports;
+}
+
+std::size_t PortSet::top_count() {
+    return sizeof(TOP_PORTS) / sizeof(TOP_PORTS[0]);
+}
+
+void PortSet::insert(Port port) {
+    if (contains(port)) return;
+    
+    mutable_words()[port / 64] |= std::uint64_t{1} << (port % 64);
+    ++size_;
+}
+
+void PortSet::insert_range(Port first, Port last) {
+    if (first > last) return;
+    
+    Words& words = mutable_words();
+    const std::size_t first_word = first / 64;
+    const std::size_t last_word = last / 64;
+    
+    // Partial words at either end, whole words in between
+    for (std::size_t i = first_word; i <= last_word; ++i) {
+        std::uint64_t mask = ~std::uint64_t{0};
+        if (i == first_word) mask &= ~std::uint64_t{0} << (first % 64);
+        if (i == last_word) mask &= ~std::uint64_t{0} >> (63 - last % 64);
+        
+        size_ += static_cast<std::size_t>(__builtin_popcountll(mask & ~words[i]));
+        words[i] |= mask;
+    }
+}
+
+void PortSet::erase(Port port) {
+    if (!contains(port)) return;
+    
+    mutable_words()[port / 64] &= ~(std::uint64_t{1} << (port % 64));
+    --size_;
+}
+
+void PortSet::erase_range(Port first, Port last) {
+    if (first > last || empty()) return;
+    
+    Words& words = mutable_words();
+    const std::size_t first_word = first / 64;
+    const std::size_t last_word = last / 64;
+    
+    for (std::size_t i = first_word; i <= last_word; ++i) {
+        std::uint64_t mask = ~std::uint64_t{0};
+        if (i == first_word) mask &= ~std::uint64_t{0} << (first % 64);
+        if (i == last_word) mask &= ~std::uint64_t{0} >> (63 - last % 64);
+        
+        size_ -= static_cast<std::size_t>(__builtin_popcountll(mask & words[i]));
+        words[i] &= ~mask;
+    }
+}
+
+void PortSet::clear() {
+    words_.reset();
+    size_ = 0;
+}
+
+PortSet& PortSet::operator|=(const PortSet& other) {
+    if (other.empty() || words_ == other.words_) return *this;
+    if (empty()) return *this = other;
+    
+    Words& words = mutable_words();
+    for (std::size_t i = 0; i < WORDS; ++i) {
+        words[i] |= (*other.words_)[i];
+    }
+    recount();
+    return *this;
+}
+
+PortSet& PortSet::operator&=(const PortSet& other) {
+    if (words_ == other.words_) return *this;
+    if (other.empty()) {
+        clear();
+        return *this;
+    }
+    if (empty()) return *this;
+    
+    Words& words = mutable_words();
+    for (std::size_t i = 0; i < WORDS; ++i) {
+        words[i] &= (*other.words_)[i];
+    }
+    recount();
+    return *this;
+}
+
+PortSet& PortSet::operator-=(const PortSet& other) {
+    if (empty() || other.empty()) return *this;
+    if (words_ == other.words_) {
+        clear();
+        return *this;
+    }
+    
+    Words& words = mutable_words();
+    for (std::size_t i = 0; i < WORDS; ++i) {
+        words[i] &= ~(*other.words_)[i];
+    }
+    recount();
+    return *this;
+}
+
+bool PortSet::operator==(const PortSet& other) const {
+    if (size_ != other.size_) return false;
+    if (words_ == other.words_ || empty()) return true;
+    return *words_ == *other.words_;
+}
+
+std::vector<Port> PortSet::to_vector() const {
+    std::vector<Port> ports;
+    ports.reserve(size_);
+    ports.insert(ports.end(), begin(), end());
+    return ports;
+}
+
+std::string PortSet::to_string() const {
+    std::string spec;
+    auto it = begin();
+    
+    while (it != end()) {
+        // Extend the run while the next port follows on
+        const Port first = *it;
+        Port last = first;
+        while (++it != end() && *it == last + 1) {
+            last = *it;
+        }
+        
+        if (!spec.empty()) spec += ",";
+        spec += std::to_string(first);
+        if (last != first) {
+            spec += "-" + std::to_string(last);
+        }
+    }
+    
+    return spec;
+}
+
+PortSet::Words& PortSet::mutable_words() {
+    if (!words_) {
+        words_ = std::make_shared<Words>();
+    } else if (words_.use_count() > 1) {
+        words_ = std::make_shared<Words>(*words_);
+    }
+    return *words_;
+}
+
+void PortSet::recount() {
+    size_ = 0;
+    for (std::uint64_t word : *words_) {
+        size_ += static_cast<std::size_t>(__builtin_popcountll(word));
+    }
+}
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "ProbeCookie.h"
+#include <random>
+
+namespace PortScanner {
+
+namespace {
+    inline std::uint64_t rotl(std::uint64_t x, int b) {
+        return (x << b) | (x >> (64 - b));
+    }
+    
+    inline void sip_round(std::uint64_t& v0, std::uint64_t& v1, std::uint64_t& v2, std::uint64_t& v3) {
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    }
+}
+
+ProbeCookie::ProbeCookie() {
+    std::random_device rd;
+    key0_ = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    key1_ = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+}
+
+ProbeCookie::ProbeCookie(std::uint64_t key0, std::uint64_t key1) : key0_(key0), key1_(key1) {}
+
+ProbeCookie::Tag ProbeCookie::make(in_addr_t ip, Port port) const {
+    const std::uint64_t hash = siphash((static_cast<std::uint64_t>(ip) << 16) | port);
+    
+    Tag tag;
+    tag.seq = static_cast<std::uint32_t>(hash);
+    tag.source_port = static_cast<Port>(SOURCE_PORT_BASE + (hash >> 32) % SOURCE_PORT_SPAN);
+    return tag;
+}
+
+bool ProbeCookie::verify(in_addr_t ip, Port port, Port source_port, std::uint32_t value, std::uint32_t offset) const {
+    const Tag tag = make(ip, port);
+    return tag.source_port == source_port && tag.seq + offset == value;
+}
+
+std::uint64_t ProbeCookie::siphash(std::uint64_t message) const {
+    // SipHash-2-4 over a single 8-byte block
+    std::uint64_t v0 = key0_ ^ 0x736f6d6570736575ULL;
+    std::uint64_t v1 = key1_ ^ 0x646f72616e646f6dULL;
+    std::uint64_t v2 = key0_ ^ 0x6c7967656e657261ULL;
+    std::uint64_t v3 = key1_ ^ 0x7465646279746573ULL;
+    
+    v3 ^= message;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= message;
+    
+    // Final block carries only the message length (8 bytes)
+    const std::uint64_t last = std::uint64_t{8} << 56;
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+    
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) {
+        sip_round(v0, v1, v2, v3);
+    }
+    
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+} // namespace PortScanner
\ No newline at end of file
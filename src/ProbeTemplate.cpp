@@ -0,0 +1,86 @@
+#include "ProbeTemplate.h"
+#include "NetworkUtils.h"
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <cstring>
+
+namespace PortScanner {
+
+namespace {
+    constexpr std::uint16_t PROBE_WINDOW = 1024;
+    constexpr std::uint16_t PROBE_MSS = 1460;
+    constexpr std::size_t MSS_OPTION_LENGTH = 4;
+}
+
+ProbeTemplate::ProbeTemplate(in_addr_t source, in_addr_t destination, std::uint8_t tcp_flags)
+    : destination_(destination), flags_(tcp_flags) {
+    const std::size_t options_length = (tcp_flags & TH_SYN) ? MSS_OPTION_LENGTH : 0;
+    const std::size_t tcp_length = sizeof(tcphdr) + options_length;
+    length_ = sizeof(iphdr) + tcp_length;
+    
+    auto* ip = reinterpret_cast<iphdr*>(packet_.data());
+    ip->version = 4;
+    ip->ihl = sizeof(iphdr) / 4;
+    ip->tot_len = htons(static_cast<std::uint16_t>(length_));
+    ip->frag_off = htons(IP_DF);
+    ip->ttl = 64;
+    ip->protocol = IPPROTO_TCP;
+    ip->saddr = source;
+    ip->daddr = destination;
+    ip->check = NetworkUtils::checksum(ip, sizeof(iphdr));
+    
+    // Ports and sequence number stay zero until build() patches them in
+    auto* tcp = reinterpret_cast<tcphdr*>(packet_.data() + sizeof(iphdr));
+    tcp->doff = static_cast<std::uint16_t>(tcp_length / 4);
+    tcp->th_flags = tcp_flags;
+    tcp->window = htons(PROBE_WINDOW);
+    
+    if (options_length > 0) {
+        // MSS option, as any real SYN would carry
+        std::uint8_t* options = packet_.data() + sizeof(iphdr) + sizeof(tcphdr);
+        options[0] = TCPOPT_MAXSEG;
+        options[1] = TCPOLEN_MAXSEG;
+        options[2] = static_cast<std::uint8_t>(PROBE_MSS >> 8);
+        options[3] = static_cast<std::uint8_t>(PROBE_MSS & 0xff);
+    }
+    
+    tcp->check = NetworkUtils::transport_checksum(source, destination, IPPROTO_TCP, tcp, tcp_length);
+}
+
+void ProbeTemplate::build(std::uint8_t* buffer, in_addr_t destination, Port source_port,
+                          Port destination_port, std::uint32_t seq) const {
+    std::memcpy(buffer, packet_.data(), length_);
+    
+    auto* ip = reinterpret_cast<iphdr*>(buffer);
+    auto* tcp = reinterpret_cast<tcphdr*>(buffer + sizeof(iphdr));
+    
+    std::uint16_t tcp_check = tcp->check;
+    
+    // The destination address is covered by the IP header and the TCP pseudo header
+    if (destination != destination_) {
+        ip->daddr = destination;
+        ip->check = NetworkUtils::checksum_adjust(ip->check, destination_, destination);
+        tcp_check = NetworkUtils::checksum_adjust(tcp_check, destination_, destination);
+    }
+    
+    tcp->source = htons(source_port);
+    tcp->dest = htons(destination_port);
+    tcp->seq = htonl(seq);
+    
+    // Both ports share one 32-bit word; old values are zero in the template
+    std::uint32_t ports;
+    std::memcpy(&ports, &tcp->source, sizeof(ports));
+    tcp_check = NetworkUtils::checksum_adjust(tcp_check, 0, ports);
+    tcp_check = NetworkUtils::checksum_adjust(tcp_check, 0, tcp->seq);
+    
+    // An RST answering an ACK takes its sequence number from our ack field
+    if (flags_ & TH_ACK) {
+        tcp->ack_seq = tcp->seq;
+        tcp_check = NetworkUtils::checksum_adjust(tcp_check, 0, tcp->ack_seq);
+    }
+    
+    tcp->check = tcp_check;
+}
+
+} // namespace PortScanner
\ No newline at end of file
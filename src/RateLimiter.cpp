@@ -0,0 +1,123 @@
+#include "RateLimiter.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace PortScanner {
+
+namespace {
+    constexpr double BURST_SECONDS = 0.010;                 // bucket depth
+    constexpr auto EPOCH = std::chrono::milliseconds(100);  // adaptive decision interval
+    constexpr std::size_t MIN_EPOCH_SAMPLES = 16;           // fewer outcomes carry no signal
+    constexpr double SPIKE_MARGIN = 0.10;                   // loss above baseline that backs off
+    constexpr double DECREASE_FACTOR = 0.5;
+    constexpr double INCREASE_DIVISOR = 16.0;               // step = starting rate / 16
+    constexpr double BASELINE_WEIGHT = 0.125;               // EWMA weight of each epoch
+    constexpr double MIN_RATE = 10.0;
+    constexpr auto MAX_SLEEP = std::chrono::milliseconds(10);   // bounds cancel latency
+}
+
+std::unique_ptr<RateLimiter> RateLimiter::from_config(const ScanConfig& config) {
+    if (config.rate == 0 && !config.adaptive_rate) {
+        return nullptr;
+    }
+    return std::make_unique<RateLimiter>(static_cast<double>(config.rate), config.adaptive_rate, config.timeout);
+}
+
+RateLimiter::RateLimiter(double rate, bool adaptive, Duration feedback_delay)
+    : rate_(rate > 0 ? rate : DEFAULT_ADAPTIVE_RATE),
+      ceiling_(rate > 0 ? rate : 0.0),
+      step_(rate_ / INCREASE_DIVISOR),
+      adaptive_(adaptive),
+      last_refill_(Clock::now()),
+      epoch_start_(last_refill_),
+      last_decrease_(last_refill_ - feedback_delay),
+      feedback_delay_(feedback_delay) {
+    // Start with one token so the first probe goes out at once
+    tokens_ = std::min(1.0, burst());
+}
+
+std::size_t RateLimiter::try_acquire(std::size_t wanted) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = Clock::now();
+    
+    if (adaptive_ && now - epoch_start_ >= EPOCH) {
+        adapt(now);
+    }
+    refill(now);
+    
+    const std::size_t granted = std::min(wanted, static_cast<std::size_t>(tokens_));
+    tokens_ -= static_cast<double>(granted);
+    return granted;
+}
+
+bool RateLimiter::acquire(const std::atomic<bool>& cancelled) {
+    while (try_acquire(1) == 0) {
+        if (cancelled.load()) return false;
+        
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(delay(), MAX_SLEEP));
+    }
+    return true;
+}
+
+std::chrono::nanoseconds RateLimiter::delay() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill(Clock::now());
+    
+    if (tokens_ >= 1.0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::nanoseconds(static_cast<std::int64_t>(std::ceil((1.0 - tokens_) / rate_ * 1e9)));
+}
+
+double RateLimiter::burst() const {
+    return std::max(1.0, rate_ * BURST_SECONDS);
+}
+
+void RateLimiter::refill(Clock::time_point now) {
+    const double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    tokens_ = std::min(burst(), tokens_ + elapsed * rate_);
+    last_refill_ = now;
+}
+
+void RateLimiter::adapt(Clock::time_point now) {
+    const std::size_t replies = replies_.load(std::memory_order_relaxed);
+    const std::size_t losses = losses_.load(std::memory_order_relaxed);
+    const std::size_t samples = replies + losses;
+    
+    // Too few outcomes (e.g. the first timeouts have not fired yet): keep
+    // counting into the same epoch
+    if (samples < MIN_EPOCH_SAMPLES) return;
+    
+    replies_.fetch_sub(replies, std::memory_order_relaxed);
+    losses_.fetch_sub(losses, std::memory_order_relaxed);
+    epoch_start_ = now;
+    
+    // Filtered ports time out by nature, so only losses beyond the usual
+    // share for this target count as congestion
+    const double loss = static_cast<double>(losses) / static_cast<double>(samples);
+    if (baseline_loss_ < 0) {
+        baseline_loss_ = loss;
+    }
+    
+    refill(now);
+    if (loss > baseline_loss_ + SPIKE_MARGIN) {
+        // Losses still trickling in from before the last cut say nothing
+        // about the current rate
+        if (now - last_decrease_ >= feedback_delay_) {
+            rate_ = std::max(MIN_RATE, rate_ * DECREASE_FACTOR);
+            last_decrease_ = now;
+        }
+    } else {
+        rate_ += step_;
+        if (ceiling_ > 0) {
+            rate_ = std::min(rate_, ceiling_);
+        }
+    }
+    tokens_ = std::min(tokens_, burst());
+    
+    // A lasting change in the loss share becomes the new normal
+    baseline_loss_ += BASELINE_WEIGHT * (loss - baseline_loss_);
+}
+
+} // namespace PortScanner
\ No newline at end of file
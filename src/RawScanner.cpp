@@ -0,0 +1,498 @@
+#include "RawScanner.h"
+#include "NetworkUtils.h"
+#include "ServiceDetector.h"
+#include <sys/socket.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <netinet/ip_icmp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace PortScanner {
+
+RawScanner::RawScanner(const ScanConfig& config) : config_(config), hosts_(config_.targets) {
+    const IPAddress& first_target = config_.targets.front();
+    source_ip_ = NetworkUtils::create_sockaddr(NetworkUtils::get_source_ip(first_target), 0).sin_addr.s_addr;
+    probe_flags_ = probe_flags(config_.scan_type);
+    sequence_space_ = ((probe_flags_ & TH_SYN) ? 1 : 0) + ((probe_flags_ & TH_FIN) ? 1 : 0);
+    template_ = std::make_unique<ProbeTemplate>(source_ip_, hosts_[0], probe_flags_);
+    
+    // Each frame is addressed to one next-hop MAC; with several targets the
+    // kernel routes every probe instead
+    if (config_.tx_ring && hosts_.size() == 1) {
+        try {
+            // Frames injected on loopback skip the output route and are dropped
+            // as martians on input, so local targets keep the raw socket
+            const LinkAddress link = NetworkUtils::resolve_link(first_target);
+            if (!link.loopback) {
+                tx_ring_ = std::make_unique<PacketTxRing>(link);
+                stats_.send_path = "ring";
+            }
+        } catch (const std::exception&) {
+            // No TX ring or unresolved next hop: send through a raw socket instead
+        }
+    }
+    
+    if (!tx_ring_) {
+        send_fd_ = NetworkUtils::create_raw_socket();
+        stats_.send_path = "socket";
+    }
+    
+    if (config_.rx_ring) {
+        try {
+            const auto prefix = hosts_.enclosing_prefix();
+            ring_ = std::make_unique<PacketRing>(prefix.first, prefix.second);
+            stats_.receive_path = "ring";
+            return;
+        } catch (const std::exception&) {
+            // No TPACKET_V3 support: read replies from a raw socket instead
+        }
+    }
+    
+    // Two more raw sockets see a copy of every inbound TCP segment and ICMP message
+    recv_fd_ = socket(AF_INET, SOCK_RAW, IPPROTO_TCP);
+    icmp_fd_ = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    if (recv_fd_ < 0 || icmp_fd_ < 0) {
+        const std::string error = strerror(errno);
+        if (send_fd_ >= 0) close(send_fd_);
+        if (recv_fd_ >= 0) close(recv_fd_);
+        if (icmp_fd_ >= 0) close(icmp_fd_);
+        throw std::runtime_error("Failed to create raw socket (requires root): " + error);
+    }
+    
+    int rcvbuf = 8 * 1024 * 1024;
+    setsockopt(recv_fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    stats_.receive_path = "socket";
+}
+
+RawScanner::~RawScanner() {
+    if (send_fd_ >= 0) close(send_fd_);
+    if (recv_fd_ >= 0) close(recv_fd_);
+    if (icmp_fd_ >= 0) close(icmp_fd_);
+}
+
+ScanResults RawScanner::scan(ProgressCallback progress_cb) {
+    space_ = ProbeSpace(config_);
+    const std::size_t total = space_.size();
+    
+    // Stateless mode keeps only the bitmaps: memory no longer scales with probes in flight
+    probes_.reset(config_.stateless ? nullptr : new Probe[total]);
+    replied_ = make_bitmap(total);
+    reset_ = make_bitmap(total);
+    unreachable_ = make_bitmap(total);
+    
+    cancelled_.store(false);
+    tx_done_.store(false);
+    answered_.store(0);
+    sent_.store(0);
+    stats_.packets_received = 0;
+    limiter_ = RateLimiter::from_config(config_);
+    rtt_.clear();
+    last_send_ns_.reset(new std::atomic<std::int64_t>[config_.targets.size()]);
+    for (std::size_t host = 0; host < config_.targets.size(); ++host) {
+        rtt_.emplace_back(config_);
+        last_send_ns_[host].store(0, std::memory_order_relaxed);
+    }
+    
+    const std::int64_t start_ns = now_ns();
+    std::int64_t tx_end_ns = 0;
+    std::int64_t rx_end_ns = 0;
+    
+    std::thread receiver([this, &progress_cb, &rx_end_ns]() {
+        receive_loop(progress_cb);
+        rx_end_ns = now_ns();
+    });
+    std::thread transmitter([this, &tx_end_ns]() {
+        transmit_loop();
+        tx_end_ns = now_ns();
+    });
+    
+    transmitter.join();
+    receiver.join();
+    
+    stats_.packets_sent = sent_.load();
+    stats_.send_time = std::chrono::nanoseconds(tx_end_ns - start_ns);
+    stats_.receive_time = std::chrono::nanoseconds(rx_end_ns - start_ns);
+    
+    ScanResults results = collect_results();
+    
+    if (progress_cb) {
+        progress_cb(total, total);
+    }
+    
+    return results;
+}
+
+void RawScanner::cancel() {
+    cancelled_.store(true);
+}
+
+void RawScanner::transmit_loop() {
+    std::uint8_t packet[64];
+    const std::size_t length = template_->size();
+    
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    
+    for (std::size_t i = 0; i < space_.size() && !cancelled_.load(); ++i) {
+        const ProbeTarget probe = space_[i];
+        const in_addr_t target_ip = hosts_[probe.host];
+        const ProbeCookie::Tag tag = cookie_.make(target_ip, probe.port);
+        
+        if (limiter_ && limiter_->try_acquire() == 0) {
+            // Out of tokens: push queued frames out before waiting
+            if (tx_ring_) {
+                tx_ring_->flush();
+            }
+            if (!limiter_->acquire(cancelled_)) break;
+        }
+        
+        // With the TX ring the probe is written straight into a mapped frame
+        std::uint8_t* buffer = packet;
+        if (tx_ring_) {
+            while (!(buffer = tx_ring_->acquire()) && !cancelled_.load()) {
+                tx_ring_->wait(10);
+            }
+            if (!buffer) break;
+        }
+        
+        template_->build(buffer, target_ip, tag.source_port, probe.port, tag.seq);
+        
+        if (probes_) {
+            probes_[i].sent_ns.store(now_ns(), std::memory_order_release);
+        }
+        
+        if (tx_ring_) {
+            tx_ring_->commit(length);
+        } else {
+            destination.sin_addr.s_addr = target_ip;
+            while (sendto(send_fd_, buffer, length, 0,
+                          reinterpret_cast<struct sockaddr*>(&destination), sizeof(destination)) < 0) {
+                // Socket buffer full: give the NIC a moment and retry
+                if ((errno != ENOBUFS && errno != EAGAIN) || cancelled_.load()) break;
+                std::this_thread::yield();
+            }
+        }
+        
+        last_send_ns_[probe.host].store(now_ns(), std::memory_order_release);
+        sent_.fetch_add(1, std::memory_order_release);
+    }
+    
+    if (tx_ring_) {
+        tx_ring_->flush();
+    }
+    
+    tx_done_.store(true, std::memory_order_release);
+}
+
+void RawScanner::receive_loop(const ProgressCallback& progress_cb) {
+    const std::size_t total = space_.size();
+    
+    auto handle_packet = [this](const std::uint8_t* packet, std::size_t length) {
+        handle_reply(packet, length);
+    };
+    
+    std::int64_t deadline = 0;
+    
+    while (!cancelled_.load()) {
+        // Done once every probe is sent and each host's last probe has had
+        // that host's timeout, as estimated from its replies so far. Replies
+        // still move the timeouts, so a deadline that has passed is worked
+        // out again before it is trusted
+        if (tx_done_.load(std::memory_order_acquire)) {
+            if (answered_.load() == total) break;
+            if (now_ns() >= deadline) {
+                deadline = receive_deadline();
+                if (now_ns() >= deadline) break;
+            }
+        }
+        
+        if (ring_) {
+            // Whole blocks at a time, parsed in place
+            const std::size_t before = answered_.load();
+            stats_.packets_received += ring_->receive(50, handle_packet);
+            
+            if (progress_cb && answered_.load() != before) {
+                progress_cb(answered_.load(), total);
+            }
+        } else {
+            receive_from_socket(progress_cb);
+        }
+    }
+}
+
+void RawScanner::receive_from_socket(const ProgressCallback& progress_cb) {
+    std::uint8_t buffer[65536];
+    pollfd pfds[2] = {{recv_fd_, POLLIN, 0}, {icmp_fd_, POLLIN, 0}};
+    
+    if (poll(pfds, 2, 50) <= 0) return;
+    
+    // Drain everything queued before polling again
+    for (const pollfd& pfd : pfds) {
+        if (!(pfd.revents & POLLIN)) continue;
+        
+        for (;;) {
+            ssize_t received = recv(pfd.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (received <= 0) break;
+            
+            ++stats_.packets_received;
+            if (handle_reply(buffer, static_cast<std::size_t>(received)) && progress_cb) {
+                progress_cb(answered_.load(), space_.size());
+            }
+        }
+    }
+}
+
+bool RawScanner::handle_reply(const std::uint8_t* packet, std::size_t length) {
+    if (length < sizeof(iphdr)) return false;
+    
+    switch (reinterpret_cast<const iphdr*>(packet)->protocol) {
+        case IPPROTO_TCP:
+            return handle_tcp_reply(packet, length);
+        case IPPROTO_ICMP:
+            return handle_icmp_reply(packet, length);
+        default:
+            return false;
+    }
+}
+
+bool RawScanner::handle_tcp_reply(const std::uint8_t* packet, std::size_t length) {
+    const auto* ip = reinterpret_cast<const iphdr*>(packet);
+    const std::size_t ip_length = ip->ihl * 4u;
+    
+    if (length < ip_length + sizeof(tcphdr)) return false;
+    
+    const std::int64_t host = hosts_.find(ip->saddr);
+    if (host < 0) return false;
+    
+    const auto* tcp = reinterpret_cast<const tcphdr*>(packet + ip_length);
+    const Port port = ntohs(tcp->source);
+    const Port source_port = ntohs(tcp->dest);
+    const std::int64_t index = space_.index_of(static_cast<std::uint32_t>(host), port);
+    if (index < 0) return false;
+    
+    if (tcp->syn && tcp->ack) {
+        // Only a SYN can be answered with SYN-ACK: ack must be our sequence + 1
+        if (!(probe_flags_ & TH_SYN) ||
+            !cookie_.verify(ip->saddr, port, source_port, ntohl(tcp->ack_seq))) {
+            return false;
+        }
+        return record_reply(index, nullptr);
+    }
+    
+    if (!tcp->rst) return false;
+    
+    // An RST acknowledges the sequence space our probe used; without ACK
+    // (answering an ACK probe) it echoes our acknowledgement number instead
+    const bool valid = tcp->ack
+        ? cookie_.verify(ip->saddr, port, source_port, ntohl(tcp->ack_seq), sequence_space_)
+        : (probe_flags_ & TH_ACK) && cookie_.verify(ip->saddr, port, source_port, ntohl(tcp->seq), 0);
+    
+    return valid && record_reply(index, &reset_);
+}
+
+bool RawScanner::handle_icmp_reply(const std::uint8_t* packet, std::size_t length) {
+    const auto* ip = reinterpret_cast<const iphdr*>(packet);
+    const std::size_t ip_length = ip->ihl * 4u;
+    
+    // Destination unreachable quotes our probe's IP header and first 8 TCP bytes
+    if (length < ip_length + sizeof(icmphdr) + sizeof(iphdr)) return false;
+    
+    const auto* icmp = reinterpret_cast<const icmphdr*>(packet + ip_length);
+    if (icmp->type != ICMP_DEST_UNREACH) return false;
+    
+    switch (icmp->code) {
+        case ICMP_HOST_UNREACH:
+        case ICMP_PROT_UNREACH:
+        case ICMP_PORT_UNREACH:
+        case ICMP_NET_ANO:
+        case ICMP_HOST_ANO:
+        case ICMP_PKT_FILTERED:
+            break;
+        default:
+            return false;
+    }
+    
+    const std::uint8_t* quoted = packet + ip_length + sizeof(icmphdr);
+    const auto* inner = reinterpret_cast<const iphdr*>(quoted);
+    const std::size_t inner_length = inner->ihl * 4u;
+    
+    if (inner->protocol != IPPROTO_TCP || inner->saddr != source_ip_ ||
+        length < ip_length + sizeof(icmphdr) + inner_length + 8) {
+        return false;
+    }
+    
+    const std::int64_t host = hosts_.find(inner->daddr);
+    if (host < 0) return false;
+    
+    // Ports and sequence number sit in the quoted 8 bytes
+    const auto* tcp = reinterpret_cast<const tcphdr*>(quoted + inner_length);
+    const Port port = ntohs(tcp->dest);
+    const std::int64_t index = space_.index_of(static_cast<std::uint32_t>(host), port);
+    
+    if (index < 0 || !cookie_.verify(inner->daddr, port, ntohs(tcp->source), ntohl(tcp->seq), 0)) {
+        return false;
+    }
+    
+    return record_reply(index, &unreachable_);
+}
+
+bool RawScanner::record_reply(std::int64_t index, const Bitmap* outcome) {
+    if (test_and_set(replied_, static_cast<std::size_t>(index))) {
+        return false;   // duplicate or retransmitted reply
+    }
+    
+    if (outcome) {
+        test_and_set(*outcome, static_cast<std::size_t>(index));
+    }
+    std::int64_t rtt_ns = 0;
+    if (probes_) {
+        const std::int64_t reply_ns = now_ns();
+        probes_[index].reply_ns.store(reply_ns, std::memory_order_release);
+        rtt_ns = reply_ns - probes_[index].sent_ns.load(std::memory_order_acquire);
+        rtt_[space_[static_cast<std::size_t>(index)].host].add_sample(std::chrono::nanoseconds(rtt_ns));
+    }
+    
+    // Open ports wait for service detection in collect_results()
+    const PortStatus status = reply_status(static_cast<std::size_t>(index));
+    if (sink_ && !cancelled_.load() && !(status == PortStatus::OPEN && config_.service_detection)) {
+        const ProbeTarget probe = space_[static_cast<std::size_t>(index)];
+        
+        ScanResult result;
+        result.host = config_.targets[probe.host];
+        result.port = probe.port;
+        result.status = status;
+        result.ip_version = IPVersion::IPv4;
+        result.response_time = std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(rtt_ns));
+        sink_->record(probe, result);
+    }
+    if (limiter_) {
+        if (outcome == &unreachable_) {
+            limiter_->on_loss();
+        } else {
+            limiter_->on_reply();
+        }
+    }
+    
+    answered_.fetch_add(1);
+    return true;
+}
+
+ScanResults RawScanner::collect_results() {
+    ScanResults results = ScanResults::for_config(config_);
+    const IPVersion ip_version = IPVersion::IPv4;
+    std::unique_ptr<ServiceDetector> detector;
+    const std::size_t sent = sent_.load(std::memory_order_acquire);
+    
+    for (std::size_t i = 0; i < space_.size(); ++i) {
+        const ProbeTarget probe = space_[i];
+        
+        ScanResult result;
+        result.host = config_.targets[probe.host];
+        result.port = probe.port;
+        result.ip_version = ip_version;
+        result.response_time = Duration{0};
+        bool deferred = false;   // goes to the sink here rather than on arrival
+        
+        if (test(replied_, i)) {
+            result.status = reply_status(i);
+            
+            // Stateless probes carry no send time, so no round trip is known
+            if (probes_) {
+                const std::int64_t rtt_ns = probes_[i].reply_ns.load() - probes_[i].sent_ns.load();
+                result.response_time = std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(rtt_ns));
+            }
+        } else if (i < sent) {
+            result.status = unanswered_status();
+            result.response_time = rtt_[probe.host].timeout_ms();
+            
+            // A timeout is only final now, unless the scan was cut short
+            deferred = !cancelled_.load();
+        } else {
+            result.status = PortStatus::UNKNOWN;   // cancelled before sending
+        }
+        
+        if (result.status == PortStatus::OPEN && config_.service_detection) {
+            if (!detector) detector = std::make_unique<ServiceDetector>();
+            
+            result.service = detector->detect_service(result.host, result.port);
+            if (config_.banner_grabbing) {
+                result.banner = detector->grab_banner(result.host, result.port, Duration{2000});
+            }
+            
+            // The reply itself is final even if the scan was cut short
+            deferred = true;
+        }
+        
+        // Other answers went to the sink as they arrived
+        if (sink_ && deferred) {
+            sink_->record(probe, result);
+        }
+        
+        results.add_result(result);
+    }
+    
+    return results;
+}
+
+PortStatus RawScanner::reply_status(std::size_t index) const {
+    if (test(unreachable_, index)) return PortStatus::FILTERED;
+    if (test(reset_, index)) return (probe_flags_ & TH_ACK) ? PortStatus::UNFILTERED : PortStatus::CLOSED;
+    return PortStatus::OPEN;
+}
+
+PortStatus RawScanner::unanswered_status() const {
+    // Open ports ignore FIN/NULL/Xmas probes; SYN and ACK are always answered
+    return (probe_flags_ & (TH_SYN | TH_ACK)) ? PortStatus::FILTERED : PortStatus::OPEN_FILTERED;
+}
+
+std::int64_t RawScanner::receive_deadline() const {
+    std::int64_t deadline = 0;
+    for (std::size_t host = 0; host < rtt_.size(); ++host) {
+        const std::int64_t sent_ns = last_send_ns_[host].load(std::memory_order_acquire);
+        if (sent_ns != 0) {
+            deadline = std::max(deadline, sent_ns + rtt_[host].timeout().count());
+        }
+    }
+    return deadline;
+}
+
+std::uint8_t RawScanner::probe_flags(ScanType scan_type) {
+    switch (scan_type) {
+        case ScanType::TCP_ACK: return TH_ACK;
+        case ScanType::TCP_FIN: return TH_FIN;
+        case ScanType::TCP_NULL: return 0;
+        case ScanType::TCP_XMAS: return TH_FIN | TH_PUSH | TH_URG;
+        default: return TH_SYN;
+    }
+}
+
+RawScanner::Bitmap RawScanner::make_bitmap(std::size_t bits) {
+    const std::size_t words = (bits + 63) / 64;
+    Bitmap bitmap(new std::atomic<std::uint64_t>[words]);
+    for (std::size_t i = 0; i < words; ++i) {
+        bitmap[i].store(0, std::memory_order_relaxed);
+    }
+    return bitmap;
+}
+
+bool RawScanner::test_and_set(const Bitmap& bitmap, std::size_t index) {
+    const std::uint64_t mask = std::uint64_t{1} << (index % 64);
+    return (bitmap[index / 64].fetch_or(mask, std::memory_order_acq_rel) & mask) != 0;
+}
+
+bool RawScanner::test(const Bitmap& bitmap, std::size_t index) {
+    return (bitmap[index / 64].load(std::memory_order_acquire) >> (index % 64)) & 1;
+}
+
+std::int64_t RawScanner::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,421 @@
+#include "ResultSerializer.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace PortScanner {
+
+namespace {
+    constexpr std::string_view STATUS_NAMES[] = {"open", "closed", "filtered", "unknown", "open|filtered", "unfiltered"};
+    
+    std::string_view status_name(PortStatus status) {
+        const auto index = static_cast<std::size_t>(status);
+        return index < std::size(STATUS_NAMES) ? STATUS_NAMES[index] : "unknown";
+    }
+    
+    // Does c need escaping: quotes, backslash and control characters in
+    // JSON; markup characters and control characters in XML
+    template <bool XML>
+    bool is_special(char c) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (byte < 0x20) return true;
+        if (XML) return c == '<' || c == '>' || c == '&' || c == '"' || c == '\'';
+        return c == '"' || c == '\\';
+    }
+    
+    using FindKernel = ResultSerializer::FindKernel;
+    
+    template <bool XML>
+    std::size_t find_special_scalar(const char* text, std::size_t length) {
+        std::size_t i = 0;
+        while (i < length && !is_special<XML>(text[i])) {
+            ++i;
+        }
+        return i;
+    }
+    
+#if defined(__x86_64__) || defined(__i386__)
+    template <bool XML>
+    __attribute__((target("sse2")))
+    std::size_t find_special_sse2(const char* text, std::size_t length) {
+        const __m128i control_max = _mm_set1_epi8(0x1f);
+        std::size_t i = 0;
+        
+        for (; i + 16 <= length; i += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            
+            // Unsigned byte <= 0x1f: the maximum with 0x1f is 0x1f itself
+            __m128i special = _mm_cmpeq_epi8(_mm_max_epu8(bytes, control_max), control_max);
+            special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')));
+            if (XML) {
+                special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('<')));
+                special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('>')));
+                special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('&')));
+                special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\'')));
+            } else {
+                special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\')));
+            }
+            
+            const int mask = _mm_movemask_epi8(special);
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+            }
+        }
+        
+        return i + find_special_scalar<XML>(text + i, length - i);
+    }
+#endif
+    
+    template <bool XML>
+    FindKernel select_find_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2")) return find_special_sse2<XML>;
+#endif
+        return find_special_scalar<XML>;
+    }
+    
+    // Host names, service names and states are shorter than one vector
+    constexpr std::size_t VECTOR_THRESHOLD = 16;
+    
+    const FindKernel find_json_special = select_find_kernel<false>();
+    const FindKernel find_xml_special = select_find_kernel<true>();
+    
+    // Append text, escaping what the format needs; runs of plain bytes go
+    // in with one append each
+    template <bool XML>
+    void append_escaped(std::string& out, std::string_view text) {
+        const FindKernel find = XML ? find_xml_special : find_json_special;
+        static const char hex[] = "0123456789abcdef";
+        std::size_t position = 0;
+        
+        while (position < text.size()) {
+            const std::size_t remaining = text.size() - position;
+            const std::size_t run = remaining < VECTOR_THRESHOLD
+                ? find_special_scalar<XML>(text.data() + position, remaining)
+                : find(text.data() + position, remaining);
+            out.append(text.data() + position, run);
+            position += run;
+            if (position == text.size()) break;
+            
+            const char c = text[position++];
+            if (XML) {
+                switch (c) {
+                    case '<': out += "&lt;"; break;
+                    case '>': out += "&gt;"; break;
+                    case '&': out += "&amp;"; break;
+                    case '"': out += "&quot;"; break;
+                    case '\'': out += "&apos;"; break;
+                    case '\t': out += "&#x9;"; break;
+                    case '\n': out += "&#xA;"; break;
+                    case '\r': out += "&#xD;"; break;
+                    default: out += "&#xFFFD;"; break;   // not allowed in XML 1.0 at all
+                }
+            } else {
+                switch (c) {
+                    case '"': out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        out += "\\u00";
+                        out += hex[(c >> 4) & 0xf];
+                        out += hex[c & 0xf];
+                        break;
+                }
+            }
+        }
+    }
+    
+    // text left-aligned in a field of width, as std::setw with std::left
+    void append_padded(std::string& out, std::string_view text, std::size_t width) {
+        out += text;
+        if (text.size() < width) {
+            out.append(width - text.size(), ' ');
+        }
+    }
+}
+
+ResultSerializer::ResultSerializer(const ScanResults& results, const std::string& format, std::size_t threads)
+    : results_(results),
+      format_(format == "json" ? Format::JSON : format == "xml" ? Format::XML
+              : format == "ndjson" ? Format::NDJSON : Format::TXT),
+      threads_(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+    // The report is by host and port; the sorted view is built here, once,
+    // and never from the formatting threads
+    if (format_ == Format::TXT) {
+        order_ = &results_.sorted_view();
+        with_host_ = results_.has_multiple_hosts();
+    }
+}
+
+bool ResultSerializer::write(std::ostream& out) const {
+    const std::size_t rows = results_.ports_.size();
+    const std::size_t chunks = (rows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    const std::size_t threads = std::min(threads_, std::max<std::size_t>(chunks, 1));
+    
+    std::string text;
+    append_header(text);
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    
+    auto format_chunk = [this, rows](std::string& buffer, std::size_t chunk) {
+        buffer.clear();
+        append_rows(buffer, chunk * CHUNK_ROWS, std::min(rows, (chunk + 1) * CHUNK_ROWS));
+    };
+    
+    if (threads <= 1) {
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+            format_chunk(text, chunk);
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+    } else {
+        // A round is one chunk per thread. The next round is formatted into
+        // the other set of buffers while this one is being written
+        std::vector<std::string> current(threads);
+        std::vector<std::string> next(threads);
+        
+        auto start_round = [&format_chunk, chunks, threads](std::vector<std::string>& buffers, std::size_t first) {
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads && first + t < chunks; ++t) {
+                workers.emplace_back([&format_chunk, &buffers, t, first]() { format_chunk(buffers[t], first + t); });
+            }
+            return workers;
+        };
+        
+        for (auto& worker : start_round(current, 0)) {
+            worker.join();
+        }
+        for (std::size_t first = 0; first < chunks; first += threads) {
+            std::vector<std::thread> workers = start_round(next, first + threads);
+            
+            for (std::size_t t = 0; t < threads && first + t < chunks; ++t) {
+                out.write(current[t].data(), static_cast<std::streamsize>(current[t].size()));
+            }
+            
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            current.swap(next);
+        }
+    }
+    
+    text.clear();
+    append_footer(text);
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    return static_cast<bool>(out);
+}
+
+void ResultSerializer::append_rows(std::string& out, std::size_t begin, std::size_t end) const {
+    const std::size_t rows = results_.ports_.size();
+    for (std::size_t i = begin; i < end; ++i) {
+        append_row(out, order_ ? (*order_)[i] : i, i + 1 == rows);
+    }
+}
+
+void ResultSerializer::append_header(std::string& out) const {
+    switch (format_) {
+        case Format::TXT: {
+            std::ostringstream header;
+            header << "PortScanner Results\n";
+            header << "==================\n\n";
+            header << "=== DETAILED SCAN RESULTS ===\n";
+            results_.print_header(header, with_host_);
+            out += header.str();
+            break;
+        }
+        
+        case Format::JSON:
+            out += "{\n  \"scan_results\": {\n    \"total_ports\": ";
+            append_number(out, static_cast<long long>(results_.total_count()));
+            out += ",\n    \"open_ports\": ";
+            append_number(out, static_cast<long long>(results_.open_count()));
+            out += ",\n    \"closed_ports\": ";
+            append_number(out, static_cast<long long>(results_.closed_count()));
+            out += ",\n    \"filtered_ports\": ";
+            append_number(out, static_cast<long long>(results_.filtered_count()));
+            out += ",\n    \"ports\": [\n";
+            break;
+        
+        case Format::XML:
+            out += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<scan_results>\n  <summary>\n    <total_ports>";
+            append_number(out, static_cast<long long>(results_.total_count()));
+            out += "</total_ports>\n    <open_ports>";
+            append_number(out, static_cast<long long>(results_.open_count()));
+            out += "</open_ports>\n    <closed_ports>";
+            append_number(out, static_cast<long long>(results_.closed_count()));
+            out += "</closed_ports>\n    <filtered_ports>";
+            append_number(out, static_cast<long long>(results_.filtered_count()));
+            out += "</filtered_ports>\n  </summary>\n  <ports>\n";
+            break;
+        
+        case Format::NDJSON:
+            break;
+    }
+}
+
+void ResultSerializer::append_footer(std::string& out) const {
+    switch (format_) {
+        case Format::TXT: {
+            // The summary sorts only the open ports; it is small
+            std::ostringstream summary;
+            summary << "\n";
+            results_.print_summary(summary);
+            out += summary.str();
+            break;
+        }
+        
+        case Format::JSON:
+            out += "    ]\n  }\n}\n";
+            break;
+        
+        case Format::XML:
+            out += "  </ports>\n</scan_results>\n";
+            break;
+        
+        case Format::NDJSON:
+            break;
+    }
+}
+
+void ResultSerializer::append_row(std::string& out, std::size_t index, bool last) const {
+    const std::string& host = results_.host(index);
+    const std::string& service = results_.service_name(index);
+    const Port port = results_.ports_[index];
+    const PortStatus status = results_.statuses_[index];
+    const std::int32_t response_ms = results_.response_ms_[index];
+    
+    switch (format_) {
+        case Format::TXT: {
+            char number[16];
+            if (with_host_) {
+                append_padded(out, host, 17);
+            }
+            append_padded(out, std::string_view(number, std::to_chars(number, number + sizeof(number), port).ptr - number), 8);
+            append_padded(out, status_name(status), 12);
+            append_padded(out, service.empty() ? std::string_view("unknown") : std::string_view(service), 15);
+            char* end = std::to_chars(number, number + sizeof(number), response_ms).ptr;
+            *end++ = 'm';
+            *end++ = 's';
+            append_padded(out, std::string_view(number, static_cast<std::size_t>(end - number)), 12);
+            out += '\n';
+            break;
+        }
+        
+        case Format::JSON:
+            out += "      {\n        \"host\": ";
+            append_json_string(out, host);
+            out += ",\n        \"port\": ";
+            append_number(out, port);
+            out += ",\n        \"status\": \"";
+            out += status_name(status);
+            out += "\",\n        \"service\": ";
+            append_json_string(out, service);
+            out += ",\n        \"response_time_ms\": ";
+            append_number(out, response_ms);
+            out += last ? "\n      }\n" : "\n      },\n";
+            break;
+        
+        case Format::XML:
+            out += "    <port>\n      <host>";
+            append_xml_text(out, host);
+            out += "</host>\n      <number>";
+            append_number(out, port);
+            out += "</number>\n      <status>";
+            out += status_name(status);
+            out += "</status>\n      <service>";
+            append_xml_text(out, service);
+            out += "</service>\n      <response_time_ms>";
+            append_number(out, response_ms);
+            out += "</response_time_ms>\n    </port>\n";
+            break;
+        
+        case Format::NDJSON:
+            append_ndjson_row(out, host, port, status, service, response_ms);
+            break;
+    }
+}
+
+void ResultSerializer::append_ndjson(std::string& out, const ScanResult& result, bool detail) {
+    append_ndjson_row(out, result.host, result.port, result.status, result.service.name,
+                      static_cast<long long>(result.response_time.count()), detail ? &result : nullptr);
+}
+
+void ResultSerializer::append_ndjson_row(std::string& out, std::string_view host, Port port, PortStatus status,
+                                         std::string_view service, long long response_ms, const ScanResult* detail) {
+    out += "{\"host\":";
+    append_json_string(out, host);
+    out += ",\"port\":";
+    append_number(out, port);
+    out += ",\"status\":\"";
+    out += status_name(status);
+    out += "\",\"service\":";
+    append_json_string(out, service);
+    
+    // The reader closes a record at its response time, so these go first
+    if (detail) {
+        auto append_field = [&out](std::string_view key, const std::string& value) {
+            if (value.empty()) return;
+            out += ",\"";
+            out += key;
+            out += "\":";
+            append_json_string(out, value);
+        };
+        append_field("version", detail->service.version);
+        append_field("product", detail->service.product);
+        append_field("extra_info", detail->service.extra_info);
+        if (detail->service.confidence != 0.0f) {
+            out += ",\"confidence\":";
+            append_float(out, detail->service.confidence);
+        }
+        append_field("banner", detail->banner);
+    }
+    
+    out += ",\"response_time_ms\":";
+    append_number(out, response_ms);
+    out += "}\n";
+}
+
+void ResultSerializer::append_json_string(std::string& out, std::string_view text) {
+    out += '"';
+    append_escaped<false>(out, text);
+    out += '"';
+}
+
+void ResultSerializer::append_xml_text(std::string& out, std::string_view text) {
+    append_escaped<true>(out, text);
+}
+
+void ResultSerializer::append_number(std::string& out, long long value) {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+std::vector<std::pair<std::string, ResultSerializer::FindKernel>> ResultSerializer::escape_kernels(bool xml) {
+    std::vector<std::pair<std::string, FindKernel>> kernels{
+        {"scalar", xml ? find_special_scalar<true> : find_special_scalar<false>}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        kernels.emplace_back("sse2", xml ? find_special_sse2<true> : find_special_sse2<false>);
+    }
+#endif
+    return kernels;
+}
+
+void ResultSerializer::append_float(std::string& out, float value) {
+    // Shortest text that reads back as the same float
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+} // namespace PortScanner
\ No newline at end of file
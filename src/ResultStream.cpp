@@ -0,0 +1,96 @@
+#include "ResultStream.h"
+#include "ResultSerializer.h"
+#include <stdexcept>
+
+namespace PortScanner {
+
+ResultStream::ResultStream(const std::string& filename)
+    : file_(filename, std::ios::out | std::ios::trunc | std::ios::binary) {
+    if (!file_.is_open()) {
+        throw std::runtime_error("Cannot open stream output file: " + filename);
+    }
+    pending_.reserve(FLUSH_BYTES * 2);
+    
+    writer_ = std::thread([this]() { write_loop(); });
+}
+
+ResultStream::~ResultStream() {
+    close();
+}
+
+void ResultStream::record(const ProbeTarget&, const ScanResult& result) {
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        append(result);
+        full = pending_.size() >= FLUSH_BYTES;
+    }
+    if (full) {
+        wake_.notify_one();
+    }
+}
+
+void ResultStream::write(const ScanResults& results) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& result : results.get_results()) {
+            append(result);
+        }
+    }
+    wake_.notify_one();
+}
+
+bool ResultStream::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !failed_;
+}
+
+std::size_t ResultStream::lines() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lines_;
+}
+
+void ResultStream::append(const ScanResult& result) {
+    ResultSerializer::append_ndjson(pending_, result);
+    ++lines_;
+}
+
+void ResultStream::write_loop() {
+    std::string batch;
+    batch.reserve(FLUSH_BYTES * 2);
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    for (;;) {
+        wake_.wait_for(lock, FLUSH_INTERVAL, [this]() { return stopping_ || pending_.size() >= FLUSH_BYTES; });
+        
+        // Take the whole buffer and leave the emptied one behind, so neither
+        // side reallocates once both have grown to their working size
+        batch.swap(pending_);
+        const bool stopping = stopping_;
+        lock.unlock();
+        
+        // Flushed every time: the file is read while it is being written
+        if (!batch.empty()) {
+            file_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            file_.flush();
+            batch.clear();
+        }
+        const bool failed = !file_;
+        
+        lock.lock();
+        failed_ = failed_ || failed;
+        if (stopping && pending_.empty()) break;
+    }
+}
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "ResultsFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PortScanner {
+
+namespace {
+    constexpr std::uint64_t ALIGNMENT = 8;
+    
+    std::uint64_t align(std::uint64_t offset) {
+        return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+}
+
+ResultsFile::ResultsFile(const std::string& filename) {
+    const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open results file: " + filename);
+    }
+    
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error(filename + " is not a binary results file");
+    }
+    
+    mapping_size_ = static_cast<std::size_t>(info.st_size);
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw std::runtime_error("Cannot map results file: " + filename);
+    }
+    
+    try {
+        header_ = static_cast<const Header*>(mapping_);
+        if (std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error(filename + " is not a binary results file");
+        }
+        if (header_->byte_order != BYTE_ORDER_MARK) {
+            throw std::runtime_error(filename + " was written on a machine of the other byte order");
+        }
+        if (header_->version != VERSION) {
+            throw std::runtime_error(filename + " is results format version " + std::to_string(header_->version) +
+                                     "; this build reads version " + std::to_string(VERSION));
+        }
+        
+        rows_ = static_cast<std::size_t>(header_->rows);
+        strings_ = static_cast<std::size_t>(header_->strings);
+        if (header_->rows > mapping_size_ || header_->strings > mapping_size_) {
+            throw std::runtime_error("Truncated or corrupt results file " + filename);
+        }
+        hosts_ = static_cast<const std::uint32_t*>(section(HOSTS, rows_ * sizeof(std::uint32_t), filename));
+        ports_ = static_cast<const Port*>(section(PORTS, rows_ * sizeof(Port), filename));
+        statuses_ = static_cast<const std::uint8_t*>(section(STATUSES, rows_, filename));
+        response_ms_ = static_cast<const std::int32_t*>(section(RESPONSE_MS, rows_ * sizeof(std::int32_t), filename));
+        services_ = static_cast<const std::uint32_t*>(section(SERVICES, rows_ * sizeof(std::uint32_t), filename));
+        banners_ = static_cast<const std::uint32_t*>(section(BANNERS, rows_ * sizeof(std::uint32_t), filename));
+        string_offsets_ = static_cast<const std::uint64_t*>(
+            section(STRING_OFFSETS, (strings_ + 1) * sizeof(std::uint64_t), filename));
+        
+        // Entries must run forward through the blob, or string() could read past it
+        for (std::size_t i = 0; i < strings_; ++i) {
+            if (string_offsets_[i] > string_offsets_[i + 1]) {
+                throw std::runtime_error("Corrupt string table in results file " + filename);
+            }
+        }
+        string_data_ = static_cast<const char*>(section(STRING_DATA, string_offsets_[strings_], filename));
+    } catch (...) {
+        munmap(mapping_, mapping_size_);
+        throw;
+    }
+}
+
+ResultsFile::~ResultsFile() {
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+    }
+}
+
+bool ResultsFile::is_results_file(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+const void* ResultsFile::section(Section section, std::uint64_t bytes, const std::string& filename) const {
+    const SectionEntry& entry = header_->sections[section];
+    if (entry.bytes != bytes || entry.offset % ALIGNMENT != 0 || entry.offset > mapping_size_ ||
+        entry.bytes > mapping_size_ - entry.offset) {
+        throw std::runtime_error("Truncated or corrupt results file " + filename);
+    }
+    return static_cast<const char*>(mapping_) + entry.offset;
+}
+
+std::size_t ResultsFile::count(PortStatus status) const noexcept {
+    return static_cast<std::size_t>(header_->status_counts[static_cast<std::size_t>(status)]);
+}
+
+std::size_t ResultsFile::total_count() const noexcept {
+    std::size_t total = 0;
+    for (std::uint64_t count : header_->status_counts) {
+        total += static_cast<std::size_t>(count);
+    }
+    return total;
+}
+
+PortStatus ResultsFile::status(std::size_t index) const {
+    const std::uint8_t status = statuses_[index];
+    return status <= static_cast<std::uint8_t>(PortStatus::UNFILTERED) ? static_cast<PortStatus>(status)
+                                                                      : PortStatus::UNKNOWN;
+}
+
+std::string_view ResultsFile::string(std::uint32_t id) const {
+    if (id >= strings_) return {};
+    return std::string_view(string_data_ + string_offsets_[id],
+                            static_cast<std::size_t>(string_offsets_[id + 1] - string_offsets_[id]));
+}
+
+ScanResult ResultsFile::at(std::size_t index) const {
+    const std::string_view address = host(index);
+    ScanResult result{port(index), status(index), Duration{response_ms(index)}, {}, std::string(banner(index)),
+                      address.find(':') != std::string_view::npos ? IPVersion::IPv6 : IPVersion::IPv4,
+                      std::string(address)};
+    result.service.name = std::string(service(index));
+    return result;
+}
+
+ScanResults ResultsFile::to_results() const {
+    ScanResults results;
+    for (std::size_t i = 0; i < rows_; ++i) {
+        results.add_result(at(i));
+    }
+    
+    // Results a --stream scan only counted have no row, but a count
+    for (std::size_t i = 0; i < results.status_counts_.size(); ++i) {
+        results.status_counts_[i] = std::max<std::size_t>(results.status_counts_[i],
+                                                          static_cast<std::size_t>(header_->status_counts[i]));
+    }
+    return results;
+}
+
+void ResultsFile::write(const ScanResults& results, std::ostream& out) {
+    const std::size_t rows = results.ports_.size();
+    
+    // One dictionary for every string: hosts first, in their interned
+    // order, then services and banners as they first appear
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, std::uint32_t> string_index;
+    auto intern = [&strings, &string_index](std::string_view text) {
+        if (text.empty()) return NO_STRING;
+        auto it = string_index.find(text);
+        if (it != string_index.end()) return it->second;
+        
+        const auto id = static_cast<std::uint32_t>(strings.size());
+        strings.push_back(text);
+        string_index.emplace(text, id);
+        return id;
+    };
+    
+    std::vector<std::uint32_t> host_ids(results.host_names_.size());
+    for (std::size_t i = 0; i < host_ids.size(); ++i) {
+        host_ids[i] = intern(results.host_names_[i]);
+    }
+    
+    std::vector<std::uint32_t> hosts(rows);
+    std::vector<std::uint32_t> services(rows, NO_STRING);
+    std::vector<std::uint32_t> banners(rows, NO_STRING);
+    for (std::size_t i = 0; i < rows; ++i) {
+        hosts[i] = host_ids[results.hosts_[i]];
+        if (results.details_[i] != ScanResults::NO_DETAIL) {
+            const ScanResults::Detail& detail = results.detail_table_[results.details_[i]];
+            services[i] = intern(results.service_names_[detail.service]);
+            banners[i] = intern(detail.banner);
+        }
+    }
+    
+    std::vector<std::uint64_t> string_offsets(strings.size() + 1, 0);
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+        string_offsets[i + 1] = string_offsets[i] + strings[i].size();
+    }
+    
+    // Lay the sections out after the header, each aligned
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.rows = rows;
+    for (std::size_t i = 0; i < results.status_counts_.size(); ++i) {
+        header.status_counts[i] = results.status_counts_[i];
+    }
+    header.strings = strings.size();
+    
+    const std::uint64_t bytes[SECTION_COUNT] = {
+        rows * sizeof(std::uint32_t), rows * sizeof(Port), rows, rows * sizeof(std::int32_t),
+        rows * sizeof(std::uint32_t), rows * sizeof(std::uint32_t),
+        string_offsets.size() * sizeof(std::uint64_t), string_offsets.back()
+    };
+    std::uint64_t offset = align(sizeof(Header));
+    for (std::size_t i = 0; i < SECTION_COUNT; ++i) {
+        header.sections[i] = SectionEntry{offset, bytes[i]};
+        offset = align(offset + bytes[i]);
+    }
+    
+    // Sections go out back to back, zero-padded up to the next offset
+    std::uint64_t written = 0;
+    auto put = [&out, &written](const void* data, std::uint64_t size) {
+        static const char padding[ALIGNMENT] = {};
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        written += size;
+        const std::uint64_t pad = align(written) - written;
+        out.write(padding, static_cast<std::streamsize>(pad));
+        written += pad;
+    };
+    
+    put(&header, sizeof(header));
+    put(hosts.data(), bytes[HOSTS]);
+    put(results.ports_.data(), bytes[PORTS]);
+    put(results.statuses_.data(), bytes[STATUSES]);
+    put(results.response_ms_.data(), bytes[RESPONSE_MS]);
+    put(services.data(), bytes[SERVICES]);
+    put(banners.data(), bytes[BANNERS]);
+    put(string_offsets.data(), bytes[STRING_OFFSETS]);
+    for (std::string_view text : strings) {
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        written += text.size();
+    }
+    put(nullptr, 0);
+}
+
+} // namespace PortScanner
\ No newline at end of file
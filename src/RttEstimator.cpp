@@ -0,0 +1,47 @@
+#include "RttEstimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace PortScanner {
+
+namespace {
+    constexpr double ALPHA = 1.0 / 8.0;     // SRTT gain
+    constexpr double BETA = 1.0 / 4.0;      // RTTVAR gain
+    constexpr double K = 4.0;               // variance multiplier
+    
+    std::int64_t to_ns(Duration duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+}
+
+RttEstimator::RttEstimator(const ScanConfig& config)
+    : RttEstimator(config.timeout, config.min_rtt_timeout,
+                   config.max_rtt_timeout.count() > 0 ? config.max_rtt_timeout : config.timeout) {
+}
+
+RttEstimator::RttEstimator(Duration initial, Duration min_timeout, Duration max_timeout)
+    : min_ns_(to_ns(std::min(min_timeout, max_timeout))),
+      max_ns_(to_ns(max_timeout)),
+      timeout_ns_(std::clamp(to_ns(initial), min_ns_, max_ns_)) {
+}
+
+void RttEstimator::add_sample(std::chrono::nanoseconds rtt) {
+    const double sample = static_cast<double>(std::max<std::int64_t>(rtt.count(), 0));
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!has_sample_) {
+        srtt_ns_ = sample;
+        rttvar_ns_ = sample / 2.0;
+        has_sample_ = true;
+    } else {
+        // Variance first, against the SRTT before this sample
+        rttvar_ns_ = (1.0 - BETA) * rttvar_ns_ + BETA * std::fabs(srtt_ns_ - sample);
+        srtt_ns_ = (1.0 - ALPHA) * srtt_ns_ + ALPHA * sample;
+    }
+    
+    const auto timeout = static_cast<std::int64_t>(srtt_ns_ + K * rttvar_ns_);
+    timeout_ns_.store(std::clamp(timeout, min_ns_, max_ns_), std::memory_order_relaxed);
+}
+
+} // namespace PortScanner
\ No newline at end of file
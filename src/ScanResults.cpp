@@ -1,85 +1,451 @@
 #include "ScanResults.h"
+#include "ResultSerializer.h"
+#include "ResultsFile.h"
 #include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <iterator>
+#include <stdexcept>
+#include <arpa/inet.h>
 
 namespace PortScanner {
 
+namespace {
+    // IPv4 hosts sort numerically, ahead of anything else (IPv6 literals)
+    std::pair<std::uint64_t, std::string> host_sort_key(const IPAddress& host) {
+        in_addr address{};
+        if (inet_pton(AF_INET, host.c_str(), &address) == 1) {
+            return {ntohl(address.s_addr), std::string()};
+        }
+        return {std::uint64_t{1} << 32, host};
+    }
+    
+    std::string trim(const std::string& text) {
+        const auto first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return "";
+        const auto last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+    
+    // Code point as UTF-8 (the Basic Multilingual Plane is all escapes use)
+    void append_utf8(std::string& out, unsigned long code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else {
+            out += static_cast<char>(0xe0 | ((code >> 12) & 0x0f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+    
+    // Inside of a JSON string, escapes resolved
+    std::string unescape_json(const std::string& text) {
+        std::string value;
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            if (text[i] != '\\' || i + 1 == text.size()) {
+                value += text[i];
+                continue;
+            }
+            const char escaped = text[++i];
+            if (escaped == 'u' && i + 4 < text.size()) {
+                append_utf8(value, std::stoul(text.substr(i + 1, 4), nullptr, 16));
+                i += 4;
+            } else {
+                value += escaped == 'n' ? '\n' : escaped == 't' ? '\t' : escaped == 'r' ? '\r' : escaped;
+            }
+        }
+        return value;
+    }
+    
+    // XML character data, entities and character references resolved
+    std::string unescape_xml(const std::string& text) {
+        std::string value;
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            const auto end = text[i] == '&' ? text.find(';', i) : std::string::npos;
+            if (end == std::string::npos) {
+                value += text[i];
+                continue;
+            }
+            
+            const std::string entity = text.substr(i + 1, end - i - 1);
+            if (entity == "lt") value += '<';
+            else if (entity == "gt") value += '>';
+            else if (entity == "amp") value += '&';
+            else if (entity == "quot") value += '"';
+            else if (entity == "apos") value += '\'';
+            else if (entity.rfind("#x", 0) == 0) append_utf8(value, std::stoul(entity.substr(2), nullptr, 16));
+            else if (entity.rfind("#", 0) == 0) append_utf8(value, std::stoul(entity.substr(1)));
+            else value += text.substr(i, end - i + 1);
+            i = end;
+        }
+        return value;
+    }
+    
+    // One field per line, as the JSON and XML writers put them:
+    // "key": value[,]  or  <key>value</key>. Empty key if neither.
+    std::pair<std::string, std::string> parse_field(const std::string& raw_line) {
+        const std::string line = trim(raw_line);
+        
+        if (line.size() > 1 && line[0] == '"') {
+            const auto key_end = line.find('"', 1);
+            const auto colon = line.find(':', key_end);
+            if (key_end == std::string::npos || colon == std::string::npos) return {};
+            
+            std::string value = trim(line.substr(colon + 1));
+            if (!value.empty() && value.back() == ',') value.pop_back();
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                value = unescape_json(value.substr(1, value.size() - 2));
+            }
+            return {line.substr(1, key_end - 1), value};
+        }
+        
+        if (line.size() > 1 && line[0] == '<' && line[1] != '/') {
+            const auto key_end = line.find('>');
+            const auto close = line.find("</", key_end);
+            if (key_end == std::string::npos || close == std::string::npos) return {};
+            return {line.substr(1, key_end - 1), unescape_xml(line.substr(key_end + 1, close - key_end - 1))};
+        }
+        
+        return {};
+    }
+    
+    // Every "key": value pair of a one-line JSON object, as NDJSON lines
+    // are written; strings are unescaped
+    std::vector<std::pair<std::string, std::string>> parse_object(const std::string& line) {
+        std::vector<std::pair<std::string, std::string>> fields;
+        std::size_t position = line.find('{');
+        
+        // The string opening at position; an escaped quote does not close it
+        auto read_string = [&line, &position]() {
+            const std::size_t begin = ++position;
+            while (position < line.size() && line[position] != '"') {
+                position += line[position] == '\\' ? 2 : 1;
+            }
+            const std::size_t end = std::min(position, line.size());
+            ++position;
+            return unescape_json(line.substr(begin, end - begin));
+        };
+        
+        while (position != std::string::npos && (position = line.find('"', position)) != std::string::npos) {
+            std::string key = read_string();
+            position = line.find(':', position);
+            if (position == std::string::npos) break;
+            position = line.find_first_not_of(" \t", position + 1);
+            if (position == std::string::npos) break;
+            
+            if (line[position] == '"') {
+                fields.emplace_back(std::move(key), read_string());
+            } else {
+                const std::size_t end = line.find_first_of(",}", position);
+                fields.emplace_back(std::move(key), trim(line.substr(position, end - position)));
+                position = end;
+            }
+        }
+        return fields;
+    }
+    
+    PortStatus string_to_status(const std::string& status) {
+        if (status == "open") return PortStatus::OPEN;
+        if (status == "closed") return PortStatus::CLOSED;
+        if (status == "filtered") return PortStatus::FILTERED;
+        if (status == "open|filtered") return PortStatus::OPEN_FILTERED;
+        if (status == "unfiltered") return PortStatus::UNFILTERED;
+        return PortStatus::UNKNOWN;
+    }
+}
+
+ScanResults ScanResults::for_config(const ScanConfig& config) {
+    ScanResults results;
+    if (config.stream) {
+        results.kept_statuses_ = 1u << static_cast<unsigned>(PortStatus::OPEN);
+        if (config.max_retries > 0) {
+            results.kept_statuses_ |= 1u << static_cast<unsigned>(PortStatus::FILTERED);
+        }
+    }
+    return results;
+}
+
 void ScanResults::add_result(const ScanResult& result) {
-    results_.push_back(result);
+    ++status_counts_[static_cast<std::size_t>(result.status)];
+    if (!keeps(result.status)) return;
+    
+    ports_.push_back(result.port);
+    statuses_.push_back(result.status);
+    response_ms_.push_back(static_cast<std::int32_t>(
+        std::min<Duration::rep>(result.response_time.count(), std::numeric_limits<std::int32_t>::max())));
+    hosts_.push_back(intern_host(result.host, result.ip_version));
+    
+    if (result.status == PortStatus::OPEN) {
+        open_indices_.push_back(static_cast<std::uint32_t>(ports_.size() - 1));
+    }
+    sorted_valid_ = false;
+    
+    // Closed and filtered ports have nothing for the side table
+    const ServiceInfo& service = result.service;
+    if (service.name.empty() && service.version.empty() && service.product.empty() &&
+        service.extra_info.empty() && service.confidence == 0.0f && result.banner.empty()) {
+        details_.push_back(NO_DETAIL);
+        return;
+    }
+    
+    details_.push_back(static_cast<std::uint32_t>(detail_table_.size()));
+    detail_table_.push_back(Detail{intern_service(service.name), service.version, service.product,
+                                   service.extra_info, service.confidence, result.banner});
 }
 
 void ScanResults::add_result(Port port, PortStatus status, Duration response_time, const std::string& service) {
     ServiceInfo service_info;
     service_info.name = service;
-    results_.emplace_back(ScanResult{port, status, response_time, service_info, ""});
+    add_result(ScanResult{port, status, response_time, service_info, "", IPVersion::IPv4, ""});
 }
 
-std::size_t ScanResults::open_count() const noexcept {
-    return std::count_if(results_.begin(), results_.end(),
-                        [](const ScanResult& r) { return r.status == PortStatus::OPEN; });
+void ScanResults::merge(ScanResults&& other) {
+    if (total_count() == 0) {
+        *this = std::move(other);
+        other.clear();
+        return;
+    }
+    
+    // The other set's interned hosts and services, as indices into ours
+    std::vector<std::uint32_t> host_map(other.host_names_.size());
+    for (std::size_t i = 0; i < host_map.size(); ++i) {
+        host_map[i] = intern_host(other.host_names_[i], other.host_versions_[i]);
+    }
+    std::vector<std::uint32_t> service_map(other.service_names_.size());
+    for (std::size_t i = 0; i < service_map.size(); ++i) {
+        service_map[i] = intern_service(other.service_names_[i]);
+    }
+    
+    const auto offset = static_cast<std::uint32_t>(ports_.size());
+    for (std::size_t i = 0; i < status_counts_.size(); ++i) {
+        status_counts_[i] += other.status_counts_[i];
+    }
+    for (std::uint32_t index : other.open_indices_) {
+        open_indices_.push_back(offset + index);
+    }
+    sorted_valid_ = false;
+    
+    ports_.insert(ports_.end(), other.ports_.begin(), other.ports_.end());
+    statuses_.insert(statuses_.end(), other.statuses_.begin(), other.statuses_.end());
+    response_ms_.insert(response_ms_.end(), other.response_ms_.begin(), other.response_ms_.end());
+    
+    hosts_.reserve(hosts_.size() + other.hosts_.size());
+    details_.reserve(details_.size() + other.details_.size());
+    for (std::size_t i = 0; i < other.hosts_.size(); ++i) {
+        hosts_.push_back(host_map[other.hosts_[i]]);
+        
+        if (other.details_[i] == NO_DETAIL) {
+            details_.push_back(NO_DETAIL);
+            continue;
+        }
+        Detail detail = std::move(other.detail_table_[other.details_[i]]);
+        detail.service = service_map[detail.service];
+        details_.push_back(static_cast<std::uint32_t>(detail_table_.size()));
+        detail_table_.push_back(std::move(detail));
+    }
+    
+    other.clear();
 }
 
-std::size_t ScanResults::closed_count() const noexcept {
-    return std::count_if(results_.begin(), results_.end(),
-                        [](const ScanResult& r) { return r.status == PortStatus::CLOSED; });
+std::vector<ScanResult> ScanResults::extract(PortStatus status) {
+    std::vector<ScanResult> extracted;
+    extracted.reserve(count_status(status));
+    std::size_t kept = 0;
+    
+    // Nothing to move: skip the pass (and keep the sorted view)
+    if (count_status(status) == 0 || !keeps(status)) {
+        return extracted;
+    }
+    
+    // Indices shift as the columns close up; the open index is rebuilt alongside
+    open_indices_.clear();
+    
+    // Compact the columns in place, keeping the order of what stays; side
+    // table entries of extracted results stay behind until clear()
+    for (std::size_t i = 0; i < ports_.size(); ++i) {
+        if (statuses_[i] == status) {
+            extracted.push_back(at(i));
+            continue;
+        }
+        if (kept != i) {
+            ports_[kept] = ports_[i];
+            statuses_[kept] = statuses_[i];
+            response_ms_[kept] = response_ms_[i];
+            hosts_[kept] = hosts_[i];
+            details_[kept] = details_[i];
+        }
+        if (statuses_[kept] == PortStatus::OPEN) {
+            open_indices_.push_back(static_cast<std::uint32_t>(kept));
+        }
+        ++kept;
+    }
+    
+    status_counts_[static_cast<std::size_t>(status)] -= extracted.size();
+    sorted_valid_ = false;
+    
+    ports_.resize(kept);
+    statuses_.resize(kept);
+    response_ms_.resize(kept);
+    hosts_.resize(kept);
+    details_.resize(kept);
+    return extracted;
 }
 
-std::size_t ScanResults::filtered_count() const noexcept {
-    return std::count_if(results_.begin(), results_.end(),
-                        [](const ScanResult& r) { return r.status == PortStatus::FILTERED; });
+std::size_t ScanResults::total_count() const noexcept {
+    std::size_t total = 0;
+    for (std::size_t count : status_counts_) {
+        total += count;
+    }
+    return total;
+}
+
+void ScanResults::clear() {
+    *this = ScanResults();
 }
 
 std::vector<ScanResult> ScanResults::get_open_ports() const {
     std::vector<ScanResult> open_ports;
-    std::copy_if(results_.begin(), results_.end(), std::back_inserter(open_ports),
-                [](const ScanResult& r) { return r.status == PortStatus::OPEN; });
+    open_ports.reserve(open_indices_.size());
+    for (std::uint32_t index : open_indices_) {
+        open_ports.push_back(at(index));
+    }
     return open_ports;
 }
 
+ScanResult ScanResults::at(std::size_t index) const {
+    const std::uint32_t host = hosts_[index];
+    ScanResult result{ports_[index], statuses_[index], Duration{response_ms_[index]}, {}, "",
+                      host_versions_[host], host_names_[host]};
+    
+    if (details_[index] != NO_DETAIL) {
+        const Detail& detail = detail_table_[details_[index]];
+        result.service = ServiceInfo{service_names_[detail.service], detail.version, detail.product,
+                                     detail.extra_info, detail.confidence};
+        result.banner = detail.banner;
+    }
+    return result;
+}
+
+std::uint32_t ScanResults::intern_host(const IPAddress& host, IPVersion ip_version) {
+    auto it = host_index_.find(host);
+    if (it != host_index_.end()) {
+        return it->second;
+    }
+    
+    const auto index = static_cast<std::uint32_t>(host_names_.size());
+    host_names_.push_back(host);
+    host_versions_.push_back(ip_version);
+    host_index_.emplace(host, index);
+    return index;
+}
+
+std::uint32_t ScanResults::intern_service(const std::string& name) {
+    auto it = service_index_.find(name);
+    if (it != service_index_.end()) {
+        return it->second;
+    }
+    
+    const auto index = static_cast<std::uint32_t>(service_names_.size());
+    service_names_.push_back(name);
+    service_index_.emplace(name, index);
+    return index;
+}
+
+const std::string& ScanResults::service_name(std::size_t index) const {
+    static const std::string none;
+    return details_[index] == NO_DETAIL ? none : service_names_[detail_table_[details_[index]].service];
+}
+
+std::vector<std::uint32_t> ScanResults::host_ranks() const {
+    // Address order of the hosts, parsed once per host rather than per comparison
+    std::vector<std::uint32_t> by_address(host_names_.size());
+    for (std::size_t i = 0; i < by_address.size(); ++i) {
+        by_address[i] = static_cast<std::uint32_t>(i);
+    }
+    std::vector<std::pair<std::uint64_t, std::string>> keys;
+    keys.reserve(host_names_.size());
+    for (const auto& host : host_names_) {
+        keys.push_back(host_sort_key(host));
+    }
+    std::sort(by_address.begin(), by_address.end(),
+              [&keys](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; });
+    
+    std::vector<std::uint32_t> ranks(host_names_.size());
+    for (std::size_t i = 0; i < by_address.size(); ++i) {
+        ranks[by_address[i]] = static_cast<std::uint32_t>(i);
+    }
+    return ranks;
+}
+
+void ScanResults::sort_by_host_and_port(std::vector<std::uint32_t>& indices) const {
+    const std::vector<std::uint32_t> ranks = host_ranks();
+    
+    // One 64-bit key per result: host rank above port
+    auto key = [this, &ranks](std::uint32_t index) {
+        return (std::uint64_t{ranks[hosts_[index]]} << 16) | ports_[index];
+    };
+    std::sort(indices.begin(), indices.end(),
+              [&key](std::uint32_t a, std::uint32_t b) { return key(a) < key(b); });
+}
+
+const std::vector<std::uint32_t>& ScanResults::sorted_view() const {
+    if (!sorted_valid_) {
+        sorted_.resize(ports_.size());
+        for (std::size_t i = 0; i < sorted_.size(); ++i) {
+            sorted_[i] = static_cast<std::uint32_t>(i);
+        }
+        sort_by_host_and_port(sorted_);
+        sorted_valid_ = true;
+    }
+    return sorted_;
+}
+
 void ScanResults::print_summary(std::ostream& os) const {
     os << "=== SCAN SUMMARY ===\n";
     os << "Total ports scanned: " << total_count() << "\n";
     os << "Open ports: " << open_count() << "\n";
     os << "Closed ports: " << closed_count() << "\n";
-    os << "Filtered ports: " << filtered_count() << "\n\n";
+    os << "Filtered ports: " << filtered_count() << "\n";
+    
+    // Only probes that can go unanswered when open (UDP, FIN/NULL/Xmas) produce this state
+    if (open_filtered_count() > 0) {
+        os << "Open|filtered ports: " << open_filtered_count() << "\n";
+    }
     
-    auto open_ports = get_open_ports();
+    // ACK scans only tell filtered from unfiltered
+    if (unfiltered_count() > 0) {
+        os << "Unfiltered ports: " << unfiltered_count() << "\n";
+    }
+    os << "\n";
+    
+    // Probes complete in scan order, which is randomized; only the open
+    // ports are sorted, never the whole result set
+    std::vector<std::uint32_t> open_ports = open_indices_;
+    sort_by_host_and_port(open_ports);
     if (!open_ports.empty()) {
+        const bool with_host = has_multiple_hosts();
+        
         os << "=== OPEN PORTS ===\n";
-        os << std::left << std::setw(8) << "PORT" 
-           << std::setw(12) << "STATE" 
-           << std::setw(15) << "SERVICE"
-           << std::setw(12) << "RESPONSE" << "\n";
-        os << std::string(47, '-') << "\n";
+        print_header(os, with_host);
         
-        for (const auto& result : open_ports) {
-            os << std::left << std::setw(8) << result.port
-               << std::setw(12) << status_to_string(result.status)
-               << std::setw(15) << (result.service.name.empty() ? "unknown" : result.service.name)
-               << std::setw(12) << (std::to_string(result.response_time.count()) + "ms") << "\n";
+        for (std::uint32_t index : open_ports) {
+            print_row(os, index, with_host);
         }
     }
 }
 
 void ScanResults::print_detailed(std::ostream& os) const {
-    os << "=== DETAILED SCAN RESULTS ===\n";
-    os << std::left << std::setw(8) << "PORT" 
-       << std::setw(12) << "STATE" 
-       << std::setw(15) << "SERVICE"
-       << std::setw(12) << "RESPONSE" << "\n";
-    os << std::string(47, '-') << "\n";
+    const bool with_host = has_multiple_hosts();
     
-    // Sort results by port number
-    auto sorted_results = results_;
-    std::sort(sorted_results.begin(), sorted_results.end(),
-             [](const ScanResult& a, const ScanResult& b) { return a.port < b.port; });
+    os << "=== DETAILED SCAN RESULTS ===\n";
+    print_header(os, with_host);
     
-    for (const auto& result : sorted_results) {
-        os << std::left << std::setw(8) << result.port
-           << std::setw(12) << status_to_string(result.status)
-           << std::setw(15) << (result.service.name.empty() ? "unknown" : result.service.name)
-           << std::setw(12) << (std::to_string(result.response_time.count()) + "ms") << "\n";
+    // Sort results by host address, then port number
+    for (std::uint32_t index : sorted_view()) {
+        print_row(os, index, with_host);
     }
     
     os << "\n";
@@ -88,89 +454,130 @@ void ScanResults::print_detailed(std::ostream& os) const {
 
 bool ScanResults::save_to_file(const std::string& filename, const std::string& format) const {
     try {
-        std::ofstream file(filename);
+        std::ofstream file(filename, format == "bin" ? std::ios::out | std::ios::binary : std::ios::out);
         if (!file.is_open()) {
             return false;
         }
         
-        if (format == "json") {
-            save_as_json(file);
-        } else if (format == "xml") {
-            save_as_xml(file);
+        if (format == "bin") {
+            ResultsFile::write(*this, file);
         } else {
-            save_as_txt(file);
+            ResultSerializer(*this, format).write(file);
         }
         
-        return true;
+        file.flush();
+        return static_cast<bool>(file);
     } catch (const std::exception&) {
         return false;
     }
 }
 
-void ScanResults::save_as_txt(std::ofstream& file) const {
-    file << "PortScanner Results\n";
-    file << "==================\n\n";
+ScanResults ScanResults::load_from_file(const std::string& filename) {
+    if (ResultsFile::is_results_file(filename)) {
+        return ResultsFile(filename).to_results();
+    }
     
-    // Redirect detailed output to file
-    print_detailed(file);
-}
-
-void ScanResults::save_as_json(std::ofstream& file) const {
-    file << "{\n";
-    file << "  \"scan_results\": {\n";
-    file << "    \"total_ports\": " << total_count() << ",\n";
-    file << "    \"open_ports\": " << open_count() << ",\n";
-    file << "    \"closed_ports\": " << closed_count() << ",\n";
-    file << "    \"filtered_ports\": " << filtered_count() << ",\n";
-    file << "    \"ports\": [\n";
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open results file: " + filename);
+    }
     
-    for (std::size_t i = 0; i < results_.size(); ++i) {
-        const auto& result = results_[i];
-        file << "      {\n";
-        file << "        \"port\": " << result.port << ",\n";
-        file << "        \"status\": \"" << status_to_string(result.status) << "\",\n";
-        file << "        \"service\": \"" << result.service.name << "\",\n";
-        file << "        \"response_time_ms\": " << result.response_time.count() << "\n";
-        file << "      }";
-        if (i < results_.size() - 1) file << ",";
-        file << "\n";
+    ScanResults results;
+    ScanResult current{0, PortStatus::UNKNOWN, Duration{0}, {}, "", IPVersion::IPv4, ""};
+    std::string line;
+    bool first_line = true;
+    
+    while (std::getline(file, line)) {
+        if (first_line && line.rfind("PortScanner Results", 0) == 0) {
+            throw std::runtime_error(filename + " is a text report; only JSON, NDJSON and XML results can be read back");
+        }
+        first_line = false;
+        
+        // NDJSON has a whole record per line; the other formats a field
+        std::vector<std::pair<std::string, std::string>> fields;
+        try {
+            if (trim(line).rfind("{\"", 0) == 0) {
+                fields = parse_object(line);
+            } else {
+                fields.push_back(parse_field(line));
+            }
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Malformed results file " + filename + ": " + trim(line));
+        }
+        
+        for (const auto& [key, value] : fields) {
+            if (key.empty()) continue;
+            
+            try {
+                if (key == "host") {
+                    // Every record opens with its host
+                    current = ScanResult{0, PortStatus::UNKNOWN, Duration{0}, {}, "", IPVersion::IPv4, value};
+                    current.ip_version = value.find(':') != std::string::npos ? IPVersion::IPv6 : IPVersion::IPv4;
+                } else if (key == "port" || key == "number") {
+                    current.port = static_cast<Port>(std::stoul(value));
+                } else if (key == "status") {
+                    current.status = string_to_status(value);
+                } else if (key == "service") {
+                    current.service.name = value;
+                } else if (key == "version") {
+                    // Service detail and banner: only checkpoint logs carry them
+                    current.service.version = value;
+                } else if (key == "product") {
+                    current.service.product = value;
+                } else if (key == "extra_info") {
+                    current.service.extra_info = value;
+                } else if (key == "confidence") {
+                    current.service.confidence = std::stof(value);
+                } else if (key == "banner") {
+                    current.banner = value;
+                } else if (key == "response_time_ms") {
+                    // ... and closes with its response time
+                    current.response_time = Duration{std::stol(value)};
+                    results.add_result(current);
+                }
+            } catch (const std::logic_error&) {
+                throw std::runtime_error("Malformed results file " + filename + ": " + trim(line));
+            }
+        }
     }
     
-    file << "    ]\n";
-    file << "  }\n";
-    file << "}\n";
+    return results;
 }
 
-void ScanResults::save_as_xml(std::ofstream& file) const {
-    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-    file << "<scan_results>\n";
-    file << "  <summary>\n";
-    file << "    <total_ports>" << total_count() << "</total_ports>\n";
-    file << "    <open_ports>" << open_count() << "</open_ports>\n";
-    file << "    <closed_ports>" << closed_count() << "</closed_ports>\n";
-    file << "    <filtered_ports>" << filtered_count() << "</filtered_ports>\n";
-    file << "  </summary>\n";
-    file << "  <ports>\n";
-    
-    for (const auto& result : results_) {
-        file << "    <port>\n";
-        file << "      <number>" << result.port << "</number>\n";
-        file << "      <status>" << status_to_string(result.status) << "</status>\n";
-        file << "      <service>" << result.service.name << "</service>\n";
-        file << "      <response_time_ms>" << result.response_time.count() << "</response_time_ms>\n";
-        file << "    </port>\n";
+bool ScanResults::has_multiple_hosts() const {
+    return host_names_.size() > 1;
+}
+
+void ScanResults::print_header(std::ostream& os, bool with_host) const {
+    if (with_host) {
+        os << std::left << std::setw(17) << "HOST";
     }
-    
-    file << "  </ports>\n";
-    file << "</scan_results>\n";
+    os << std::left << std::setw(8) << "PORT" 
+       << std::setw(12) << "STATE" 
+       << std::setw(15) << "SERVICE"
+       << std::setw(12) << "RESPONSE" << "\n";
+    os << std::string(with_host ? 64 : 47, '-') << "\n";
+}
+
+void ScanResults::print_row(std::ostream& os, std::size_t index, bool with_host) const {
+    const std::string& service = service_name(index);
+    if (with_host) {
+        os << std::left << std::setw(17) << host(index);
+    }
+    os << std::left << std::setw(8) << ports_[index]
+       << std::setw(12) << status_to_string(statuses_[index])
+       << std::setw(15) << (service.empty() ? "unknown" : service)
+       << std::setw(12) << (std::to_string(response_ms_[index]) + "ms") << "\n";
 }
 
-std::string ScanResults::status_to_string(PortStatus status) const {
+std::string ScanResults::status_to_string(PortStatus status) {
     switch (status) {
         case PortStatus::OPEN: return "open";
         case PortStatus::CLOSED: return "closed";
         case PortStatus::FILTERED: return "filtered";
         case PortStatus::UNKNOWN: return "unknown";
+        case PortStatus::OPEN_FILTERED: return "open|filtered";
+        case PortStatus::UNFILTERED: return "unfiltered";
         default: return "unknown";
     }
 }
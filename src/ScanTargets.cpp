@@ -0,0 +1,217 @@
+#include "ScanTargets.h"
+#include "NetworkUtils.h"
+#include <arpa/inet.h>
+#include <algorithm>
+
+namespace PortScanner {
+
+namespace {
+    // SplitMix64 finalizer: the Feistel round function and key schedule
+    std::uint64_t mix(std::uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
+    }
+}
+
+ProbePermutation::ProbePermutation(std::uint64_t size, std::uint64_t seed) : size_(size), keyed_(true) {
+    // Both halves together must cover size; at most a 4x larger domain
+    half_bits_ = 1;
+    while (half_bits_ < 32 && (std::uint64_t{1} << (2 * half_bits_)) < size) {
+        ++half_bits_;
+    }
+    half_mask_ = (std::uint64_t{1} << half_bits_) - 1;
+    
+    std::uint64_t state = seed;
+    for (auto& key : keys_) {
+        state += 0x9e3779b97f4a7c15ULL;
+        key = mix(state);
+    }
+}
+
+std::uint64_t ProbePermutation::operator()(std::uint64_t index) const {
+    if (!keyed_) return index;
+    
+    // Cycle walking: values past the end are encrypted again until one lands inside
+    std::uint64_t value = encrypt(index);
+    while (value >= size_) {
+        value = encrypt(value);
+    }
+    return value;
+}
+
+std::uint64_t ProbePermutation::inverse(std::uint64_t value) const {
+    if (!keyed_) return value;
+    
+    std::uint64_t index = decrypt(value);
+    while (index >= size_) {
+        index = decrypt(index);
+    }
+    return index;
+}
+
+std::uint64_t ProbePermutation::encrypt(std::uint64_t value) const {
+    std::uint64_t left = value >> half_bits_;
+    std::uint64_t right = value & half_mask_;
+    
+    for (int round = 0; round < ROUNDS; ++round) {
+        const std::uint64_t next = left ^ (mix(right ^ keys_[round]) & half_mask_);
+        left = right;
+        right = next;
+    }
+    return (left << half_bits_) | right;
+}
+
+std::uint64_t ProbePermutation::decrypt(std::uint64_t value) const {
+    std::uint64_t left = value >> half_bits_;
+    std::uint64_t right = value & half_mask_;
+    
+    for (int round = ROUNDS - 1; round >= 0; --round) {
+        const std::uint64_t previous = right ^ (mix(left ^ keys_[round]) & half_mask_);
+        right = left;
+        left = previous;
+    }
+    return (left << half_bits_) | right;
+}
+
+ProbeSpace::ProbeSpace(const ScanConfig& config)
+    : host_count_(config.targets.size()), port_set_(config.ports), ports_(config.ports.to_vector()),
+      port_rank_(PortSet::WORDS), shard_index_(config.shard_index),
+      shard_count_(std::max<std::size_t>(config.shard_count, 1)), size_(probe_count(config)) {
+    // A port's position is the ports before its word plus those below it in the word
+    std::uint32_t rank = 0;
+    for (std::size_t i = 0; i < PortSet::WORDS; ++i) {
+        port_rank_[i] = rank;
+        rank += static_cast<std::uint32_t>(__builtin_popcountll(port_set_.word(i)));
+    }
+    
+    // The permutation spans every shard's pairs; each shard strides over it
+    if (config.randomize) {
+        permutation_ = ProbePermutation(host_count_ * ports_.size(), config.seed);
+    }
+    
+    if (!config.pending.empty()) {
+        runs_ = config.pending;
+        run_offsets_.reserve(runs_.size());
+        std::uint64_t offset = 0;
+        for (const auto& run : runs_) {
+            run_offsets_.push_back(offset);
+            offset += run.second - run.first;
+        }
+    }
+}
+
+ProbeSpace::ProbeSpace(std::vector<ProbeTarget> probes)
+    : probes_(std::move(probes)), size_(probes_.size()) {
+}
+
+ProbeSpace ProbeSpace::from_results(const std::vector<ScanResult>& results, const std::vector<IPAddress>& targets) {
+    std::unordered_map<IPAddress, std::uint32_t> host_index;
+    host_index.reserve(targets.size());
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        host_index.emplace(targets[i], static_cast<std::uint32_t>(i));
+    }
+    
+    std::vector<ProbeTarget> probes;
+    probes.reserve(results.size());
+    for (const auto& result : results) {
+        auto it = host_index.find(result.host);
+        if (it != host_index.end()) {
+            probes.push_back(ProbeTarget{it->second, result.port});
+        }
+    }
+    return ProbeSpace(std::move(probes));
+}
+
+std::int64_t ProbeSpace::index_of(std::uint32_t host, Port port) const {
+    if (port_rank_.empty() || host >= host_count_ || !port_set_.contains(port)) {
+        return -1;
+    }
+    const std::uint64_t below = port_set_.word(port / 64) & ((std::uint64_t{1} << (port % 64)) - 1);
+    const std::uint64_t port_index = port_rank_[port / 64] + static_cast<std::uint64_t>(__builtin_popcountll(below));
+    const std::uint64_t pair = port_index * host_count_ + host;
+    std::uint64_t position = permutation_.inverse(pair);
+    if (position % shard_count_ != shard_index_) {
+        return -1;
+    }
+    position /= shard_count_;
+    if (runs_.empty()) {
+        return static_cast<std::int64_t>(position);
+    }
+    
+    // Last run starting at or before the position, if the position is inside it
+    auto run = std::upper_bound(runs_.begin(), runs_.end(), position,
+                                [](std::uint64_t value, const auto& r) { return value < r.first; });
+    if (run == runs_.begin() || position >= (--run)->second) {
+        return -1;
+    }
+    const auto r = static_cast<std::size_t>(run - runs_.begin());
+    return static_cast<std::int64_t>(run_offsets_[r] + position - run->first);
+}
+
+std::uint64_t ProbeSpace::pending_position(std::uint64_t index) const {
+    const auto offset = std::upper_bound(run_offsets_.begin(), run_offsets_.end(), index) - 1;
+    const auto r = static_cast<std::size_t>(offset - run_offsets_.begin());
+    return runs_[r].first + (index - *offset);
+}
+
+std::size_t probe_count(const ScanConfig& config) {
+    if (!config.pending.empty()) {
+        std::size_t left = 0;
+        for (const auto& run : config.pending) {
+            left += run.second - run.first;
+        }
+        return left;
+    }
+    
+    const std::size_t total = config.targets.size() * config.ports.size();
+    const std::size_t shards = std::max<std::size_t>(config.shard_count, 1);
+    if (config.shard_index >= total) {
+        return 0;
+    }
+    return (total - config.shard_index + shards - 1) / shards;
+}
+
+HostTable::HostTable(const std::vector<IPAddress>& targets) {
+    addresses_.reserve(targets.size());
+    for (const auto& target : targets) {
+        addresses_.push_back(NetworkUtils::create_sockaddr(target, 0).sin_addr.s_addr);
+    }
+    
+    // A single target is compared directly
+    if (addresses_.size() > 1) {
+        index_.reserve(addresses_.size());
+        for (std::size_t i = 0; i < addresses_.size(); ++i) {
+            index_.emplace(addresses_[i], static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+std::int64_t HostTable::find(in_addr_t address) const {
+    if (addresses_.size() == 1) {
+        return addresses_[0] == address ? 0 : -1;
+    }
+    
+    auto it = index_.find(address);
+    return it == index_.end() ? -1 : static_cast<std::int64_t>(it->second);
+}
+
+std::pair<in_addr_t, in_addr_t> HostTable::enclosing_prefix() const {
+    if (addresses_.empty()) return {0, 0};
+    
+    // Every bit that differs between two targets is a host bit
+    const std::uint32_t first = ntohl(addresses_[0]);
+    std::uint32_t differing = 0;
+    for (in_addr_t address : addresses_) {
+        differing |= ntohl(address) ^ first;
+    }
+    
+    const int prefix_length = differing == 0 ? 32 : __builtin_clz(differing);
+    const std::uint32_t mask = prefix_length == 0 ? 0 : ~std::uint32_t{0} << (32 - prefix_length);
+    return {htonl(first & mask), htonl(mask)};
+}
+
+} // namespace PortScanner
\ No newline at end of file
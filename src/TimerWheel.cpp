@@ -0,0 +1,193 @@
+#include "TimerWheel.h"
+#include <algorithm>
+#include <climits>
+
+namespace PortScanner {
+
+namespace {
+    std::uint64_t rotate_right(std::uint64_t bits, std::size_t shift) {
+        shift &= 63;
+        return shift == 0 ? bits : (bits >> shift) | (bits << (64 - shift));
+    }
+}
+
+TimerWheel::TimerWheel(std::size_t capacity) {
+    reset(capacity);
+}
+
+void TimerWheel::reset(std::size_t capacity) {
+    origin_ = Clock::now();
+    current_ = 0;
+    size_ = 0;
+    nodes_.assign(capacity, Node{});
+    
+    for (auto& level : heads_) {
+        level.fill(NIL);
+    }
+    occupied_.fill(0);
+}
+
+void TimerWheel::schedule(TimerId id, Clock::time_point deadline) {
+    if (id >= nodes_.size()) {
+        nodes_.resize(id + 1);
+    }
+    
+    if (nodes_[id].armed) {
+        unlink(id);
+        --size_;
+    }
+    
+    // Round up so a timer never fires before its deadline
+    nodes_[id].expires = to_tick(deadline, true);
+    link(id);
+    ++size_;
+}
+
+void TimerWheel::cancel(TimerId id) {
+    if (id >= nodes_.size() || !nodes_[id].armed) return;
+    
+    unlink(id);
+    --size_;
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<TimerId>& expired) {
+    const std::uint64_t target = to_tick(now, false);
+    
+    while (current_ <= target && size_ > 0) {
+        const std::size_t index = current_ & (SLOTS - 1);
+        
+        // Entering a new block of a higher level: move its timers down
+        if (index == 0) {
+            for (std::size_t level = 1; level < LEVELS; ++level) {
+                cascade(level);
+                if (((current_ >> (SLOT_BITS * level)) & (SLOTS - 1)) != 0) break;
+            }
+        }
+        
+        while (heads_[0][index] != NIL) {
+            TimerId id = heads_[0][index];
+            unlink(id);
+            --size_;
+            expired.push_back(id);
+        }
+        
+        ++current_;
+    }
+    
+    // Nothing left to expire; skip the idle ticks in one step
+    if (size_ == 0 && current_ <= target) {
+        current_ = target + 1;
+    }
+}
+
+int TimerWheel::next_timeout_ms(Clock::time_point now) const {
+    if (size_ == 0) return -1;
+    
+    const std::uint64_t now_tick = to_tick(now, false);
+    std::uint64_t nearest = UINT64_MAX;
+    
+    for (std::size_t level = 0; level < LEVELS; ++level) {
+        if (occupied_[level] == 0) continue;
+        
+        const std::size_t shift = SLOT_BITS * level;
+        const std::uint64_t block = current_ >> shift;
+        std::uint64_t bits = rotate_right(occupied_[level], block & (SLOTS - 1));
+        
+        // Once its block has started, an upper level's current slot only
+        // holds timers a full turn away
+        const bool block_started = level > 0 && (current_ & ((std::uint64_t{1} << shift) - 1)) != 0;
+        if (block_started) bits &= ~std::uint64_t{1};
+        
+        const std::uint64_t distance = bits == 0 ? SLOTS : static_cast<std::uint64_t>(__builtin_ctzll(bits));
+        
+        // Level 0 slots expire at that tick; upper slots cascade at block start
+        std::uint64_t tick = level == 0 ? current_ + distance : (block + distance) << shift;
+        nearest = std::min(nearest, tick);
+    }
+    
+    if (nearest <= now_tick) return 0;
+    return static_cast<int>(std::min<std::uint64_t>(nearest - now_tick, INT_MAX));
+}
+
+std::uint64_t TimerWheel::to_tick(Clock::time_point tp, bool round_up) const {
+    if (tp <= origin_) return 0;
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(tp - origin_).count();
+    auto ticks = static_cast<std::uint64_t>(elapsed / 1000);
+    
+    if (round_up && elapsed % 1000 != 0) {
+        ++ticks;
+    }
+    return ticks;
+}
+
+void TimerWheel::link(TimerId id) {
+    Node& node = nodes_[id];
+    const std::uint64_t delta = node.expires > current_ ? node.expires - current_ : 0;
+    
+    // Pick the lowest level whose span covers the remaining time
+    std::size_t level = 0;
+    while (level + 1 < LEVELS && delta >= (std::uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    
+    std::uint64_t expires = node.expires;
+    if (delta == 0) {
+        expires = current_;
+    } else if (delta >= (std::uint64_t{1} << (SLOT_BITS * LEVELS))) {
+        // Beyond the wheel's range: park in the farthest slot and re-cascade
+        expires = current_ + (std::uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+    }
+    
+    const std::size_t slot = (expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+    
+    node.level = static_cast<std::uint8_t>(level);
+    node.slot = static_cast<std::uint8_t>(slot);
+    node.prev = NIL;
+    node.next = heads_[level][slot];
+    node.armed = true;
+    
+    if (node.next != NIL) {
+        nodes_[node.next].prev = id;
+    }
+    heads_[level][slot] = id;
+    occupied_[level] |= std::uint64_t{1} << slot;
+}
+
+void TimerWheel::unlink(TimerId id) {
+    Node& node = nodes_[id];
+    
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.level][node.slot] = node.next;
+    }
+    
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    }
+    
+    if (heads_[node.level][node.slot] == NIL) {
+        occupied_[node.level] &= ~(std::uint64_t{1} << node.slot);
+    }
+    
+    node.prev = NIL;
+    node.next = NIL;
+    node.armed = false;
+}
+
+void TimerWheel::cascade(std::size_t level) {
+    const std::size_t slot = (current_ >> (SLOT_BITS * level)) & (SLOTS - 1);
+    
+    TimerId id = heads_[level][slot];
+    heads_[level][slot] = NIL;
+    occupied_[level] &= ~(std::uint64_t{1} << slot);
+    
+    while (id != NIL) {
+        TimerId next = nodes_[id].next;
+        link(id);
+        id = next;
+    }
+}
+
+} // namespace PortScanner
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "UdpScanner.h"
+#include "NetworkUtils.h"
+#include "ServiceDetector.h"
+#include <linux/errqueue.h>
+#include <netinet/ip_icmp.h>
+#include <unistd.h>
+#include <poll.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace PortScanner {
+
+namespace {
+    constexpr char PROBE_PAYLOAD[] = "test";
+    constexpr std::size_t REPLY_BUFFER_SIZE = 512;     // only the source address matters
+    constexpr std::size_t CONTROL_BUFFER_SIZE = 128;   // sock_extended_err + offender address
+    
+    // A pending ICMP error is reported once through the next send/recv call;
+    // with IP_RECVERR the error itself also sits on the error queue
+    bool is_reported_icmp_error(int error) {
+        return error == ECONNREFUSED || error == EHOSTUNREACH || error == ENETUNREACH ||
+               error == EHOSTDOWN || error == ENONET || error == EPROTO;
+    }
+}
+
+UdpScanner::UdpScanner(const ScanConfig& config) : config_(config), hosts_(config_.targets) {
+    for (std::size_t i = 0; i < SOCKET_COUNT; ++i) {
+        try {
+            lanes_[i].fd = NetworkUtils::create_udp_socket();
+        } catch (...) {
+            for (std::size_t j = 0; j < i; ++j) close(lanes_[j].fd);
+            throw;
+        }
+        
+        const int fd = lanes_[i].fd;
+        NetworkUtils::set_socket_nonblocking(fd);
+        
+        // Deliver ICMP errors for unconnected sends to the error queue
+        int one = 1;
+        setsockopt(fd, IPPROTO_IP, IP_RECVERR, &one, sizeof(one));
+        
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+}
+
+UdpScanner::~UdpScanner() {
+    for (auto& lane : lanes_) {
+        if (lane.fd >= 0) close(lane.fd);
+    }
+}
+
+ScanResults UdpScanner::scan(ProgressCallback progress_cb) {
+    space_ = ProbeSpace(config_);
+    const std::size_t total = space_.size();
+    
+    probes_.assign(total, Probe{});
+    
+    for (std::size_t i = 0; i < SOCKET_COUNT; ++i) {
+        lanes_[i].next = i;
+    }
+    
+    answered_ = 0;
+    cancelled_.store(false);
+    limiter_ = RateLimiter::from_config(config_);
+    rate_credit_ = 0;
+    rtt_.clear();
+    for (std::size_t host = 0; host < config_.targets.size(); ++host) {
+        rtt_.emplace_back(config_);
+    }
+    last_send_ns_.assign(config_.targets.size(), 0);
+    
+    std::int64_t deadline = 0;
+    pollfd pfds[SOCKET_COUNT];
+    
+    while (!cancelled_.load()) {
+        bool tx_pending = false;
+        
+        for (std::size_t i = 0; i < SOCKET_COUNT; ++i) {
+            Lane& lane = lanes_[i];
+            if (lane.next < total) {
+                send_batch(lane);
+            }
+            
+            pfds[i].fd = lane.fd;
+            pfds[i].events = POLLIN | (lane.next < total ? POLLOUT : 0);
+            pfds[i].revents = 0;
+            tx_pending = tx_pending || lane.next < total;
+        }
+        
+        // Done once every probe is sent and each host's last probe has had
+        // that host's timeout, as estimated from its replies and ICMP errors
+        // so far. Those still move the timeouts, so a deadline that has
+        // passed is worked out again before it is trusted
+        if (!tx_pending) {
+            if (answered_ == total) break;
+            if (now_ns() >= deadline) {
+                deadline = receive_deadline();
+                if (now_ns() >= deadline) break;
+            }
+        }
+        
+        int poll_ms = tx_pending ? 10 : 50;
+        if (tx_pending && limiter_ && rate_credit_ == 0) {
+            // Sockets stay writable while we wait for tokens: sleep on
+            // replies only, until the next token is due
+            const auto delay = limiter_->delay();
+            if (delay.count() > 0) {
+                for (auto& pfd : pfds) pfd.events = POLLIN;
+                poll_ms = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(delay).count());
+            }
+        }
+        
+        if (poll(pfds, SOCKET_COUNT, poll_ms) <= 0) continue;
+        
+        const std::size_t answered_before = answered_;
+        for (std::size_t i = 0; i < SOCKET_COUNT; ++i) {
+            if (pfds[i].revents & POLLERR) drain_errors(pfds[i].fd);
+            if (pfds[i].revents & POLLIN) drain_replies(pfds[i].fd);
+        }
+        
+        if (progress_cb && answered_ != answered_before) {
+            progress_cb(answered_, total);
+        }
+    }
+    
+    ScanResults results = collect_results();
+    
+    if (progress_cb) {
+        progress_cb(total, total);
+    }
+    
+    return results;
+}
+
+void UdpScanner::cancel() {
+    cancelled_.store(true);
+}
+
+std::size_t UdpScanner::send_batch(Lane& lane) {
+    const std::size_t total = space_.size();
+    
+    mmsghdr messages[BATCH_SIZE];
+    sockaddr_in addresses[BATCH_SIZE];
+    iovec payload{const_cast<char*>(PROBE_PAYLOAD), sizeof(PROBE_PAYLOAD) - 1};
+    
+    // Trim the batch to the rate tokens we hold; a pending ICMP error can
+    // cut a sendmmsg short, so unspent tokens carry over to the next batch
+    std::size_t limit = BATCH_SIZE;
+    if (limiter_) {
+        rate_credit_ += limiter_->try_acquire(BATCH_SIZE - rate_credit_);
+        limit = rate_credit_;
+        if (limit == 0) return 0;
+    }
+    
+    // This lane owns every SOCKET_COUNT-th probe starting at its own index
+    std::size_t count = 0;
+    for (std::size_t index = lane.next; index < total && count < limit; index += SOCKET_COUNT, ++count) {
+        const ProbeTarget probe = space_[index];
+        addresses[count] = sockaddr_in{};
+        addresses[count].sin_family = AF_INET;
+        addresses[count].sin_addr.s_addr = hosts_[probe.host];
+        addresses[count].sin_port = htons(probe.port);
+        
+        messages[count] = mmsghdr{};
+        messages[count].msg_hdr.msg_name = &addresses[count];
+        messages[count].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[count].msg_hdr.msg_iov = &payload;
+        messages[count].msg_hdr.msg_iovlen = 1;
+    }
+    
+    int sent;
+    do {
+        sent = sendmmsg(lane.fd, messages, static_cast<unsigned>(count), 0);
+    } while (sent < 0 && (errno == EINTR || is_reported_icmp_error(errno)));
+    
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == ENOBUFS) return 0;
+        
+        if (limiter_) --rate_credit_;
+        
+        // Refused locally (e.g. by a firewall rule): give up on this probe only
+        probes_[lane.next].sent_ns = now_ns();
+        probes_[lane.next].status = PortStatus::UNKNOWN;
+        lane.next += SOCKET_COUNT;
+        return 0;
+    }
+    
+    if (limiter_) rate_credit_ -= static_cast<std::size_t>(sent);
+    
+    const std::int64_t now = now_ns();
+    for (int i = 0; i < sent; ++i) {
+        probes_[lane.next].sent_ns = now;
+        last_send_ns_[space_[lane.next].host] = now;
+        lane.next += SOCKET_COUNT;
+    }
+    
+    return static_cast<std::size_t>(sent);
+}
+
+void UdpScanner::drain_replies(int fd) {
+    mmsghdr messages[BATCH_SIZE];
+    sockaddr_in addresses[BATCH_SIZE];
+    iovec buffers[BATCH_SIZE];
+    char data[BATCH_SIZE][REPLY_BUFFER_SIZE];
+    
+    for (;;) {
+        for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            buffers[i] = iovec{data[i], REPLY_BUFFER_SIZE};
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            messages[i].msg_hdr.msg_iov = &buffers[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        
+        int received = recvmmsg(fd, messages, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        if (received < 0) {
+            if (errno == EINTR || is_reported_icmp_error(errno)) continue;
+            return;
+        }
+        
+        for (int i = 0; i < received; ++i) {
+            record(addresses[i].sin_addr.s_addr, ntohs(addresses[i].sin_port), PortStatus::OPEN);
+        }
+        
+        if (static_cast<std::size_t>(received) < BATCH_SIZE) return;
+    }
+}
+
+void UdpScanner::drain_errors(int fd) {
+    mmsghdr messages[BATCH_SIZE];
+    sockaddr_in addresses[BATCH_SIZE];
+    char control[BATCH_SIZE][CONTROL_BUFFER_SIZE];
+    char discard[BATCH_SIZE][16];
+    iovec buffers[BATCH_SIZE];
+    
+    for (;;) {
+        for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            buffers[i] = iovec{discard[i], sizeof(discard[i])};
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            messages[i].msg_hdr.msg_iov = &buffers[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_control = control[i];
+            messages[i].msg_hdr.msg_controllen = CONTROL_BUFFER_SIZE;
+        }
+        
+        int received = recvmmsg(fd, messages, BATCH_SIZE, MSG_ERRQUEUE | MSG_DONTWAIT, nullptr);
+        if (received <= 0) return;
+        
+        for (int i = 0; i < received; ++i) {
+            // msg_name holds the original destination of the failed datagram
+            const in_addr_t address = addresses[i].sin_addr.s_addr;
+            msghdr& header = messages[i].msg_hdr;
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+                if (cmsg->cmsg_level != IPPROTO_IP || cmsg->cmsg_type != IP_RECVERR) continue;
+                
+                const auto* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+                if (error->ee_origin != SO_EE_ORIGIN_ICMP || error->ee_type != ICMP_DEST_UNREACH) continue;
+                
+                const Port port = ntohs(addresses[i].sin_port);
+                switch (error->ee_code) {
+                    case ICMP_PORT_UNREACH:
+                        record(address, port, PortStatus::CLOSED);
+                        break;
+                    case ICMP_HOST_UNREACH:
+                    case ICMP_PROT_UNREACH:
+                    case ICMP_NET_ANO:
+                    case ICMP_HOST_ANO:
+                    case ICMP_PKT_FILTERED:
+                        record(address, port, PortStatus::FILTERED);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        
+        if (static_cast<std::size_t>(received) < BATCH_SIZE) return;
+    }
+}
+
+void UdpScanner::record(in_addr_t address, Port port, PortStatus status) {
+    const std::int64_t host = hosts_.find(address);
+    if (host < 0) return;
+    
+    const std::int64_t index = space_.index_of(static_cast<std::uint32_t>(host), port);
+    if (index < 0) return;
+    
+    Probe& probe = probes_[index];
+    if (probe.reply_ns != 0 || probe.sent_ns == 0) return;   // duplicate, or not ours
+    
+    probe.reply_ns = now_ns();
+    probe.status = status;
+    ++answered_;
+    rtt_[static_cast<std::size_t>(host)].add_sample(std::chrono::nanoseconds(probe.reply_ns - probe.sent_ns));
+    
+    // Open ports wait for service detection in collect_results()
+    if (sink_ && !cancelled_.load() && !(status == PortStatus::OPEN && config_.service_detection)) {
+        const ProbeTarget target{static_cast<std::uint32_t>(host), port};
+        
+        ScanResult result;
+        result.host = config_.targets[target.host];
+        result.port = port;
+        result.status = status;
+        result.ip_version = IPVersion::IPv4;
+        result.response_time = std::chrono::duration_cast<Duration>(
+            std::chrono::nanoseconds(probe.reply_ns - probe.sent_ns));
+        sink_->record(target, result);
+    }
+    
+    // Port unreachable is the closed-port answer; other unreachables are losses
+    if (limiter_) {
+        if (status == PortStatus::FILTERED) {
+            limiter_->on_loss();
+        } else {
+            limiter_->on_reply();
+        }
+    }
+}
+
+ScanResults UdpScanner::collect_results() {
+    ScanResults results = ScanResults::for_config(config_);
+    std::unique_ptr<ServiceDetector> detector;
+    
+    for (std::size_t i = 0; i < probes_.size(); ++i) {
+        const Probe& probe = probes_[i];
+        
+        const ProbeTarget target = space_[i];
+        
+        ScanResult result;
+        result.host = config_.targets[target.host];
+        result.port = target.port;
+        result.status = probe.status;
+        result.ip_version = IPVersion::IPv4;
+        bool deferred = false;   // goes to the sink here rather than on arrival
+        
+        if (probe.sent_ns == 0) {
+            result.status = PortStatus::UNKNOWN;   // cancelled before sending
+            result.response_time = Duration{0};
+        } else if (probe.reply_ns != 0) {
+            result.response_time = std::chrono::duration_cast<Duration>(
+                std::chrono::nanoseconds(probe.reply_ns - probe.sent_ns));
+        } else {
+            result.response_time = rtt_[target.host].timeout_ms();
+            
+            // A timeout is only final now, unless the scan was cut short
+            deferred = !cancelled_.load();
+        }
+        
+        if (result.status == PortStatus::OPEN && config_.service_detection) {
+            if (!detector) detector = std::make_unique<ServiceDetector>();
+            result.service = detector->detect_service(result.host, result.port);
+            
+            // The reply itself is final even if the scan was cut short
+            deferred = true;
+        }
+        
+        // Other answers went to the sink as they arrived
+        if (sink_ && deferred) {
+            sink_->record(target, result);
+        }
+        
+        results.add_result(result);
+    }
+    
+    return results;
+}
+
+std::int64_t UdpScanner::receive_deadline() const {
+    std::int64_t deadline = 0;
+    for (std::size_t host = 0; host < rtt_.size(); ++host) {
+        if (last_send_ns_[host] != 0) {
+            deadline = std::max(deadline, last_send_ns_[host] + rtt_[host].timeout().count());
+        }
+    }
+    return deadline;
+}
+
+std::int64_t UdpScanner::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace PortScanner
\ No newline at end of file
@@ -1,10 +1,15 @@
 #include "ArgumentsManager.h"
 #include "PortScanner.h"
 #include "ConfigManager.h"
+#include "NetworkUtils.h"
+#include "Checkpoint.h"
 #include <iostream>
 #include <iomanip>
 #include <csignal>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <set>
 
 namespace {
     std::atomic<bool> interrupted{false};
@@ -40,6 +45,85 @@ namespace {
             std::cout << std::endl;
         }
     }
+    
+    // Where results go without -o: named after the targets (and the shard)
+    std::string default_output_file(const PortScanner::ScanConfig& config) {
+        // CIDR slashes and list commas have no place in a file name
+        std::string target_name = config.target;
+        std::replace_if(target_name.begin(), target_name.end(),
+                        [](char c) { return c == '/' || c == ','; }, '_');
+        if (config.shard_count > 1) {
+            target_name += "_shard" + std::to_string(config.shard_index + 1) + "of"
+                         + std::to_string(config.shard_count);
+        }
+        return "scan_results_" + target_name + "." + config.output_format;
+    }
+    
+    // "merge" subcommand: one report from the per-shard result files
+    int run_merge(const PortScanner::ScanConfig& config) {
+        PortScanner::ScanResults merged;
+        std::set<std::pair<PortScanner::IPAddress, PortScanner::Port>> seen;
+        std::size_t duplicates = 0;
+        
+        for (const auto& filename : config.merge_files) {
+            auto shard = PortScanner::ScanResults::load_from_file(filename);
+            std::cout << "Loaded " << shard.total_count() << " results from " << filename << "\n";
+            
+            // Shards of one seed are disjoint; keep the first copy if they were not
+            for (const auto& result : shard.get_results()) {
+                if (seen.emplace(result.host, result.port).second) {
+                    merged.add_result(result);
+                } else {
+                    ++duplicates;
+                }
+            }
+        }
+        
+        if (duplicates > 0) {
+            std::cerr << "Warning: " << duplicates << " (host, port) pairs appear in more than one file; "
+                      << "were the shards run with the same --seed?\n";
+        }
+        std::cout << "\n";
+        
+        if (config.verbose) {
+            merged.print_detailed();
+        } else {
+            merged.print_summary();
+        }
+        
+        const std::string filename = config.output_file.empty()
+            ? "scan_results_merged." + config.output_format
+            : config.output_file;
+        if (!merged.save_to_file(filename, config.output_format)) {
+            std::cerr << "Error: cannot write " << filename << "\n";
+            return 1;
+        }
+        std::cout << "\nResults saved to: " << filename << "\n";
+        return 0;
+    }
+    
+    // "convert" subcommand: one results file rewritten in another format
+    int run_convert(const PortScanner::ScanConfig& config) {
+        const auto results = PortScanner::ScanResults::load_from_file(config.convert_file);
+        
+        // Without -o, the input's name with the new format's extension
+        std::string filename = config.output_file;
+        if (filename.empty()) {
+            const auto slash = config.convert_file.find_last_of('/');
+            const auto dot = config.convert_file.find_last_of('.');
+            const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+            filename = (has_extension ? config.convert_file.substr(0, dot) : config.convert_file) + "." +
+                       config.output_format;
+        }
+        
+        if (!results.save_to_file(filename, config.output_format)) {
+            std::cerr << "Error: cannot write " << filename << "\n";
+            return 1;
+        }
+        std::cout << "Converted " << results.total_count() << " results from " << config.convert_file
+                  << " to " << filename << "\n";
+        return 0;
+    }
 }
 
 int main(int argc, char* argv[]) {
@@ -54,32 +138,112 @@ int main(int argc, char* argv[]) {
         
         auto config = args_manager.get_config();
         
+        if (!config.merge_files.empty()) {
+            return run_merge(config);
+        }
+        if (!config.convert_file.empty()) {
+            return run_convert(config);
+        }
+        
         // Load configuration file if specified
         if (!config.config_file.empty()) {
             try {
                 auto file_config = PortScanner::ConfigManager::load_from_file(config.config_file);
                 config = PortScanner::ConfigManager::merge_configs(file_config, config);
+                if (config.targets.empty()) {
+                    config.targets = PortScanner::NetworkUtils::expand_targets(config.target);
+                }
             } catch (const std::exception& e) {
                 std::cerr << "Warning: Failed to load config file: " << e.what() << "\n";
             }
         }
         
+        // A resumed scan is the checkpoint's scan: same targets, ports, order
+        // and shard. This command line only decides how it is reported
+        PortScanner::ScanResults resumed_results;
+        bool resuming = false;
+        if (!config.resume_file.empty()) {
+            auto state = PortScanner::Checkpoint::load(config.resume_file);
+            state.config.output_file = config.output_file;
+            state.config.output_format = config.output_format;
+            state.config.stream = config.stream;
+            state.config.verbose = config.verbose;
+            state.config.service_detection = config.service_detection;
+            state.config.banner_grabbing = config.banner_grabbing;
+            state.config.checkpoint_file = config.checkpoint_file.empty() ? config.resume_file : config.checkpoint_file;
+            state.config.checkpoint_interval = config.checkpoint_interval;
+            state.config.resume_file = config.resume_file;
+            config = std::move(state.config);
+            resumed_results = std::move(state.results);
+            resuming = true;
+        }
+        
+        // A streamed scan writes its output file from the start
+        if (config.stream && config.output_file.empty()) {
+            config.output_file = default_output_file(config);
+        }
+        
+        // Create scanner with enhanced configuration (this also fixes the probe order seed)
+        PortScanner::PortScanner scanner(config);
+        const auto& scan_config = scanner.get_config();
+        
         std::cout << "PortScanner v2.1.0 - Advanced Edition\n";
-        std::cout << "Target: " << config.target << "\n";
+        std::cout << "Target: " << config.target;
+        if (config.targets.size() > 1) {
+            std::cout << " (" << config.targets.size() << " hosts)";
+        }
+        std::cout << "\n";
         std::cout << "Ports: " << config.ports.size() << " ports to scan\n";
         std::cout << "Scan Type: " << PortScanner::ConfigManager::scan_type_to_string(config.scan_type) << "\n";
         std::cout << "Threads: " << config.thread_count << "\n";
+        if (config.rate > 0 || config.adaptive_rate) {
+            const auto rate = config.rate > 0 ? config.rate
+                                              : static_cast<std::size_t>(PortScanner::RateLimiter::DEFAULT_ADAPTIVE_RATE);
+            std::cout << "Rate: " << rate << " probes/s"
+                      << (config.adaptive_rate ? (config.rate > 0 ? " (adaptive, max)" : " (adaptive, start)") : "")
+                      << "\n";
+        }
+        std::cout << "Probe order: "
+                  << (scan_config.randomize ? "random (seed " + std::to_string(scan_config.seed) + ")" : "sequential")
+                  << "\n";
+        if (config.shard_count > 1) {
+            std::cout << "Shard: " << config.shard_index + 1 << "/" << config.shard_count
+                      << " (" << PortScanner::probe_count(scan_config) << " probes)\n";
+        }
+        if (resuming) {
+            std::cout << "Resumed: " << resumed_results.total_count() << " results from " << config.resume_file
+                      << ", " << (config.pending.empty() ? 0 : PortScanner::probe_count(scan_config))
+                      << " probes left\n";
+        }
+        if (config.discover) {
+            std::cout << "Host discovery: ICMP echo, UDP, TCP connect to " << config.ping_ports.size()
+                      << " ports\n";
+        }
+        if (config.stream) {
+            std::cout << "Streaming: " << config.output_file << " (NDJSON)\n";
+        }
         std::cout << "Timeout: " << config.timeout.count() << "ms\n";
         std::cout << "Service Detection: " << (config.service_detection ? "enabled" : "disabled") << "\n";
         std::cout << "Banner Grabbing: " << (config.banner_grabbing ? "enabled" : "disabled") << "\n\n";
         
-        // Create scanner with enhanced configuration
-        PortScanner::PortScanner scanner(config);
-        
         // Enable high-performance mode for large scans
-        if (config.ports.size() > 1000 || config.thread_count > 200) {
+        const std::size_t probe_count = PortScanner::probe_count(scan_config);
+        if (probe_count > 1000 || config.thread_count > 200) {
             scanner.set_performance_mode(true);
-            std::cout << "High-performance async mode enabled\n\n";
+            
+            const bool io_uring = PortScanner::AsyncScanner::uses_io_uring(config);
+            if (config.async_backend == PortScanner::AsyncBackend::IO_URING && !io_uring) {
+                std::cerr << "Warning: io_uring backend unavailable"
+                          << (config.max_retries > 0 ? " (--max-retries needs socket options set from the ring, Linux 6.7+)"
+                                                     : "")
+                          << "; using epoll\n";
+            }
+            std::cout << "High-performance async mode enabled ("
+                      << (config.reactor_count == 0 ? std::string("auto") : std::to_string(config.reactor_count))
+                      << " reactors, "
+                      << PortScanner::ConfigManager::backend_to_string(io_uring ? PortScanner::AsyncBackend::IO_URING
+                                                                                 : PortScanner::AsyncBackend::EPOLL)
+                      << " backend)\n\n";
         }
         
         auto progress_callback = [](std::size_t completed, std::size_t total) {
@@ -89,13 +253,58 @@ int main(int argc, char* argv[]) {
         };
         
         // Use async scanning for better performance
-        auto future_results = scanner.scan_ports_async(progress_callback);
+        auto scan_start = std::chrono::steady_clock::now();
+        PortScanner::ScanResults results;
+        bool streamed = config.stream;
+        if (resuming && config.pending.empty()) {
+            // The checkpoint is of a finished scan: report it as it is
+            results = std::move(resumed_results);
+            streamed = false;
+        } else {
+            scanner.set_resumed_results(std::move(resumed_results));
+            auto future_results = scanner.scan_ports_async(progress_callback);
+            
+            // Wait for results or interruption; an interrupt cancels the scan,
+            // which then saves its checkpoint
+            while (future_results.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+                if (interrupted.load()) {
+                    scanner.cancel_scan();
+                    break;
+                }
+            }
+            results = future_results.get();
+        }
+        auto scan_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - scan_start);
         
-        // Wait for results or interruption
-        auto results = future_results.get();
+        // Discovery is timed on its own, not as part of the port scan
+        const auto& discovery = scanner.discovery_stats();
+        scan_time -= discovery.elapsed;
         
         if (!interrupted.load()) {
-            std::cout << "\nScan completed!\n\n";
+            if (discovery.hosts > 0) {
+                auto ms = [](std::chrono::nanoseconds elapsed) {
+                    return std::chrono::duration<double, std::milli>(elapsed).count();
+                };
+                std::cout << "\nDiscovery: " << discovery.live << "/" << discovery.hosts << " hosts up in "
+                          << std::fixed << std::setprecision(2) << std::chrono::duration<double>(discovery.elapsed).count()
+                          << "s (" << discovery.probes_sent << " probes, latency avg " << ms(discovery.mean_latency)
+                          << "ms, max " << ms(discovery.max_latency) << "ms)";
+            }
+            std::cout << "\nScan completed in " << std::fixed << std::setprecision(2) << scan_time.count()
+                      << "s (" << std::setprecision(0) << (results.total_count() / std::max(scan_time.count(), 1e-6))
+                      << " ports/s)\n";
+            
+            const auto packets = scanner.packet_stats();
+            if (packets.packets_sent > 0) {
+                auto per_second = [](std::size_t count, std::chrono::nanoseconds elapsed) {
+                    return count / std::max(std::chrono::duration<double>(elapsed).count(), 1e-6);
+                };
+                std::cout << "Packets: " << packets.packets_sent << " sent via " << packets.send_path << " ("
+                          << per_second(packets.packets_sent, packets.send_time) << " packets/s), "
+                          << packets.packets_received << " received via " << packets.receive_path << " ("
+                          << per_second(packets.packets_received, packets.receive_time) << " packets/s)\n";
+            }
+            std::cout << "\n";
             
             if (config.verbose) {
                 results.print_detailed();
@@ -103,12 +312,15 @@ int main(int argc, char* argv[]) {
                 results.print_summary();
             }
             
-            // Save results if there are open ports or output file specified
-            if (results.open_count() > 0 || !config.output_file.empty()) {
-                std::string filename = config.output_file;
-                if (filename.empty()) {
-                    filename = "scan_results_" + config.target + "." + config.output_format;
-                }
+            // Save results if there are open ports or output file specified;
+            // a shard always saves, the merge needs every part. A streamed
+            // scan's file is already written, and memory holds only part of it
+            if (streamed) {
+                std::cout << "\nResults streamed to: " << config.output_file << " ("
+                          << scanner.stream_lines() << " results)\n";
+            } else if (results.open_count() > 0 || !config.output_file.empty() || config.shard_count > 1) {
+                const std::string filename = config.output_file.empty() ? default_output_file(config)
+                                                                        : config.output_file;
                 
                 if (results.save_to_file(filename, config.output_format)) {
                     std::cout << "\nResults saved to: " << filename << "\n";
@@ -120,7 +332,13 @@ int main(int argc, char* argv[]) {
                 PortScanner::ConfigManager::save_to_file(config, config.config_file);
             }
         } else {
-            scanner.cancel_scan();
+            if (streamed) {
+                std::cout << "Results so far streamed to " << config.output_file << "\n";
+            }
+            if (!config.checkpoint_file.empty()) {
+                std::cout << "Checkpoint saved to " << config.checkpoint_file
+                          << "; continue with --resume " << config.checkpoint_file << "\n";
+            }
         }
         
         return 0;
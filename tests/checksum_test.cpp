@@ -0,0 +1,101 @@
+// Checks every checksum kernel the CPU supports, and NetworkUtils::checksum,
+// against a byte-pair RFC 1071 reference
+
+#include "NetworkUtils.h"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <random>
+
+using namespace PortScanner;
+
+namespace {
+    std::uint16_t fold(std::uint64_t sum) {
+        while (sum >> 16) {
+            sum = (sum & 0xffff) + (sum >> 16);
+        }
+        return static_cast<std::uint16_t>(sum);
+    }
+    
+    // RFC 1071 section 4.1: big-endian 16-bit words, an odd last byte padded with zero
+    std::uint16_t reference_sum(const std::uint8_t* bytes, std::size_t length) {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i + 1 < length; i += 2) {
+            sum += static_cast<std::uint64_t>(bytes[i]) << 8 | bytes[i + 1];
+        }
+        if (length % 2) {
+            sum += static_cast<std::uint64_t>(bytes[length - 1]) << 8;
+        }
+        return fold(sum);
+    }
+    
+    std::size_t failures = 0;
+    
+    void check(const char* what, const std::uint8_t* bytes, std::size_t length, std::size_t offset) {
+        const std::uint16_t expected = reference_sum(bytes, length);
+        
+        // Kernels sum in native order; the folded sums differ only by a byte swap
+        for (const auto& [name, kernel] : NetworkUtils::checksum_kernels()) {
+            const std::uint16_t sum = ntohs(fold(kernel(bytes, length)));
+            if (sum != expected) {
+                std::printf("FAIL %s kernel %s: length %zu offset %zu: %04x, expected %04x\n",
+                            what, name.c_str(), length, offset, sum, expected);
+                ++failures;
+            }
+        }
+        
+        const std::uint16_t checksum = ntohs(NetworkUtils::checksum(bytes, length));
+        if (checksum != static_cast<std::uint16_t>(~expected)) {
+            std::printf("FAIL %s checksum(): length %zu offset %zu: %04x, expected %04x\n",
+                        what, length, offset, checksum, static_cast<std::uint16_t>(~expected));
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    constexpr std::size_t MAX_LENGTH = 65535;
+    
+    // Room for the longest buffer at any offset up to 7
+    std::vector<std::uint8_t> random(MAX_LENGTH + 8);
+    std::vector<std::uint8_t> ones(MAX_LENGTH + 8, 0xff);
+    std::mt19937 rng(1071);
+    for (auto& byte : random) {
+        byte = static_cast<std::uint8_t>(rng());
+    }
+    
+    // Every length to 2000 at every offset, so the kernels' loops and tails
+    // all run from both aligned and odd addresses, then the largest IP packet
+    std::vector<std::size_t> lengths;
+    for (std::size_t length = 0; length <= 2000; ++length) {
+        lengths.push_back(length);
+    }
+    lengths.push_back(MAX_LENGTH);
+    
+    std::size_t checks = 0;
+    for (std::size_t length : lengths) {
+        for (std::size_t offset = 0; offset < 8; ++offset) {
+            check("random", random.data() + offset, length, offset);
+            check("all-0xff", ones.data() + offset, length, offset);
+            checks += 2;
+        }
+    }
+    
+    // Random lengths over random data, drawn afresh each time
+    std::uniform_int_distribution<std::size_t> any_length(0, MAX_LENGTH);
+    for (int i = 0; i < 2000; ++i) {
+        const std::size_t offset = rng() % 8;
+        std::vector<std::uint8_t> buffer(any_length(rng) + offset);
+        for (auto& byte : buffer) {
+            byte = static_cast<std::uint8_t>(rng());
+        }
+        check("random length", buffer.data() + offset, buffer.size() - offset, offset);
+        ++checks;
+    }
+    
+    std::string names;
+    for (const auto& kernel : NetworkUtils::checksum_kernels()) {
+        names += " " + kernel.first;
+    }
+    std::printf("%zu buffers checked with kernels:%s; %zu failures\n", checks, names.c_str(), failures);
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+// Checks the result serializer: every escape kernel the CPU supports against
+// a reference, JSON/XML/NDJSON files read back by ScanResults::load_from_file,
+// and output that does not depend on the thread count
+
+#include "ResultSerializer.h"
+#include "ScanResults.h"
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <unistd.h>
+
+using namespace PortScanner;
+
+namespace {
+    std::size_t failures = 0;
+    
+    // What each format must escape, written out independently of the serializer
+    bool reference_special(unsigned char byte, bool xml) {
+        if (byte < 0x20) return true;
+        if (xml) return byte == '<' || byte == '>' || byte == '&' || byte == '"' || byte == '\'';
+        return byte == '"' || byte == '\\';
+    }
+    
+    // One special byte at every position of every length to 48 (three
+    // vectors, so tails of every size follow), from every address modulo 16
+    void check_kernels(bool xml) {
+        const char* format = xml ? "xml" : "json";
+        const auto kernels = ResultSerializer::escape_kernels(xml);
+        std::vector<char> buffer(48 + 16);
+        std::size_t checks = 0;
+        
+        for (int value = 0; value < 256; ++value) {
+            const auto byte = static_cast<unsigned char>(value);
+            
+            for (std::size_t offset = 0; offset < 16; ++offset) {
+                char* text = buffer.data() + offset;
+                
+                for (std::size_t length = 0; length <= 48; ++length) {
+                    // No special byte at all, then one at each position
+                    for (std::size_t position = 0; position <= length; ++position) {
+                        std::fill(buffer.begin(), buffer.end(), 'a');
+                        if (position < length) {
+                            text[position] = static_cast<char>(byte);
+                        }
+                        const std::size_t expected =
+                            position < length && reference_special(byte, xml) ? position : length;
+                        
+                        for (const auto& [name, kernel] : kernels) {
+                            const std::size_t found = kernel(text, length);
+                            if (found != expected) {
+                                std::printf("FAIL %s kernel %s: byte 0x%02x at %zu of %zu, offset %zu: %zu, expected %zu\n",
+                                            format, name.c_str(), value, position, length, offset, found, expected);
+                                ++failures;
+                            }
+                        }
+                        ++checks;
+                    }
+                }
+            }
+        }
+        
+        std::string names;
+        for (const auto& kernel : kernels) {
+            names += " " + kernel.first;
+        }
+        std::printf("%s: %zu texts checked with kernels:%s\n", format, checks, names.c_str());
+    }
+    
+    // Service names that need every kind of escape, some longer than a
+    // vector so the SIMD path runs, and a plain one
+    const std::vector<std::string> SERVICES = {
+        "http",
+        "say \"hi\" <b>&amp;</b> 'x'",
+        "C:\\path\\to\\a\\very\\long\\service\\name",
+        "tab\there, newline\nthere, return\rthere",
+        "control \x01\x02\x1f bytes past sixteen",
+        "caf\xc3\xa9 \xe2\x9c\x93 utf-8 passes through unchanged",
+        "",
+    };
+    
+    ScanResults make_results(std::size_t rows) {
+        ScanResults results;
+        std::mt19937 rng(4627);
+        const PortStatus statuses[] = {PortStatus::OPEN, PortStatus::CLOSED, PortStatus::FILTERED,
+                                       PortStatus::OPEN_FILTERED, PortStatus::UNFILTERED};
+        
+        for (std::size_t i = 0; i < rows; ++i) {
+            ScanResult result{static_cast<Port>(1 + rng() % 65535), statuses[rng() % 5],
+                              Duration{static_cast<long>(rng() % 5000)}, {}, "", IPVersion::IPv4,
+                              "10.0." + std::to_string(rng() % 4) + "." + std::to_string(rng() % 256)};
+            if (i % 7 == 0) {
+                result.host = "fd00::" + std::to_string(rng() % 16);
+                result.ip_version = IPVersion::IPv6;
+            }
+            if (result.status == PortStatus::OPEN) {
+                result.service.name = SERVICES[rng() % SERVICES.size()];
+            }
+            results.add_result(result);
+        }
+        return results;
+    }
+    
+    // XML 1.0 cannot hold control characters other than tab, newline and
+    // return; the writer puts U+FFFD in their place
+    std::string xml_expected(const std::string& text) {
+        std::string expected;
+        for (char c : text) {
+            if (static_cast<unsigned char>(c) < 0x20 && c != '\t' && c != '\n' && c != '\r') {
+                expected += "\xef\xbf\xbd";
+            } else {
+                expected += c;
+            }
+        }
+        return expected;
+    }
+    
+    void check_same(const char* what, const ScanResult& read, const ScanResult& written, bool xml, bool detail) {
+        const std::string service = xml ? xml_expected(written.service.name) : written.service.name;
+        bool same = read.host == written.host && read.port == written.port && read.status == written.status &&
+                    read.response_time == written.response_time && read.service.name == service;
+        if (detail) {
+            same = same && read.service.version == written.service.version &&
+                   read.service.product == written.service.product &&
+                   read.service.extra_info == written.service.extra_info &&
+                   read.service.confidence == written.service.confidence && read.banner == written.banner;
+        }
+        if (!same) {
+            std::printf("FAIL %s: %s:%u read back as %s:%u\n", what, written.host.c_str(), written.port,
+                        read.host.c_str(), read.port);
+            ++failures;
+        }
+    }
+    
+    void check_round_trip(const ScanResults& results, const std::string& directory) {
+        for (const std::string format : {"json", "xml", "ndjson"}) {
+            const std::string filename = directory + "/results." + format;
+            if (!results.save_to_file(filename, format)) {
+                std::printf("FAIL %s: cannot write %s\n", format.c_str(), filename.c_str());
+                ++failures;
+                continue;
+            }
+            
+            const ScanResults read = ScanResults::load_from_file(filename);
+            if (read.total_count() != results.total_count()) {
+                std::printf("FAIL %s: %zu results read back, %zu written\n", format.c_str(), read.total_count(),
+                            results.total_count());
+                ++failures;
+                continue;
+            }
+            for (std::size_t i = 0; i < results.total_count(); ++i) {
+                check_same(format.c_str(), read.at(i), results.at(i), format == "xml", false);
+            }
+            std::remove(filename.c_str());
+        }
+        std::printf("json, xml, ndjson: %zu results read back\n", results.total_count());
+    }
+    
+    // The checkpoint log's lines: NDJSON with service detail and banner
+    void check_detail_round_trip(const std::string& directory) {
+        std::vector<ScanResult> written;
+        std::string text;
+        for (std::size_t i = 0; i < SERVICES.size(); ++i) {
+            ScanResult result{static_cast<Port>(20 + i), PortStatus::OPEN, Duration{static_cast<long>(i)},
+                              {SERVICES[i], SERVICES[(i + 1) % SERVICES.size()], SERVICES[(i + 2) % SERVICES.size()],
+                               SERVICES[(i + 3) % SERVICES.size()], 0.1f * static_cast<float>(i)},
+                              SERVICES[(i + 4) % SERVICES.size()], IPVersion::IPv4, "192.0.2.1"};
+            ResultSerializer::append_ndjson(text, result, true);
+            written.push_back(result);
+        }
+        
+        const std::string filename = directory + "/detail.ndjson";
+        std::FILE* file = std::fopen(filename.c_str(), "wb");
+        std::fwrite(text.data(), 1, text.size(), file);
+        std::fclose(file);
+        
+        const ScanResults read = ScanResults::load_from_file(filename);
+        if (read.total_count() != written.size()) {
+            std::printf("FAIL ndjson detail: %zu results read back, %zu written\n", read.total_count(), written.size());
+            ++failures;
+        } else {
+            for (std::size_t i = 0; i < written.size(); ++i) {
+                check_same("ndjson detail", read.at(i), written[i], false, true);
+            }
+        }
+        std::remove(filename.c_str());
+        std::printf("ndjson with detail: %zu results read back\n", written.size());
+    }
+    
+    // Rows past several chunk boundaries come out the same from one thread as from many
+    void check_threads(const ScanResults& results) {
+        for (const std::string format : {"txt", "json", "xml", "ndjson"}) {
+            std::ostringstream single;
+            std::ostringstream parallel;
+            ResultSerializer(results, format, 1).write(single);
+            ResultSerializer(results, format, 4).write(parallel);
+            
+            if (single.str() != parallel.str()) {
+                std::printf("FAIL %s: 1 and 4 threads differ (%zu and %zu bytes)\n", format.c_str(),
+                            single.str().size(), parallel.str().size());
+                ++failures;
+            }
+        }
+        std::printf("txt, json, xml, ndjson: 1 and 4 threads agree over %zu rows\n", results.total_count());
+    }
+}
+
+int main() {
+    check_kernels(false);
+    check_kernels(true);
+    
+    char directory[] = "/tmp/serializer_test.XXXXXX";
+    if (!mkdtemp(directory)) {
+        std::printf("FAIL cannot create a temporary directory\n");
+        return 1;
+    }
+    
+    // Three full chunks and a partial one
+    const ScanResults results = make_results(3 * ResultSerializer::CHUNK_ROWS + 1234);
+    check_round_trip(results, directory);
+    check_detail_round_trip(directory);
+    check_threads(results);
+    rmdir(directory);
+    
+    std::printf("%zu failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
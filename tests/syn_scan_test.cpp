@@ -0,0 +1,312 @@
+// Checks the raw SYN engine against loopback: probe cookies accept only the
+// reply they were made for, and a scan of a small range finds the ports
+// listening there open and the rest closed, even when every reply arrives
+// twice and a forged SYN-ACK comes first. Needs CAP_NET_RAW; without it
+// only the cookie checks run and the test reports itself skipped.
+
+#include "NetworkUtils.h"
+#include "ProbeCookie.h"
+#include "RawScanner.h"
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace PortScanner;
+
+namespace {
+    std::size_t failures = 0;
+    
+    // ctest's SKIP_RETURN_CODE for this test
+    constexpr int SKIPPED = 77;
+    
+    // Ports scanned: a run below the cookies' source ports, listeners on a few of them
+    constexpr std::size_t RANGE = 24;
+    const std::size_t LISTENING[] = {0, 5, 11};
+    
+    void check(bool ok, const char* what) {
+        if (!ok) {
+            std::printf("FAIL %s\n", what);
+            ++failures;
+        }
+    }
+    
+    void check_cookie() {
+        const in_addr_t ip = inet_addr("192.0.2.7");
+        const ProbeCookie cookie(0x0123456789abcdefULL, 0xfedcba9876543210ULL);
+        const ProbeCookie other(0x0123456789abcdefULL, 0xfedcba9876543211ULL);
+        const ProbeCookie::Tag tag = cookie.make(ip, 443);
+        
+        check(tag.source_port >= ProbeCookie::SOURCE_PORT_BASE &&
+              tag.source_port < ProbeCookie::SOURCE_PORT_BASE + ProbeCookie::SOURCE_PORT_SPAN,
+              "cookie: source port outside the ephemeral range");
+        check(ProbeCookie(0x0123456789abcdefULL, 0xfedcba9876543210ULL).make(ip, 443).seq == tag.seq,
+              "cookie: same key and probe, different sequence");
+        check(cookie.make(ip, 444).seq != tag.seq, "cookie: next port, same sequence");
+        
+        // A SYN-ACK acknowledges seq + 1, an RST answering an ACK echoes seq
+        check(cookie.verify(ip, 443, tag.source_port, tag.seq + 1), "cookie: SYN-ACK rejected");
+        check(cookie.verify(ip, 443, tag.source_port, tag.seq, 0), "cookie: RST echo rejected");
+        check(!cookie.verify(ip, 443, tag.source_port, tag.seq), "cookie: unacknowledged sequence accepted");
+        check(!cookie.verify(ip, 443, tag.source_port, tag.seq + 2), "cookie: wrong acknowledgement accepted");
+        check(!cookie.verify(ip, 443, tag.source_port + 1, tag.seq + 1), "cookie: wrong source port accepted");
+        check(!cookie.verify(ip, 444, tag.source_port, tag.seq + 1), "cookie: another port's reply accepted");
+        check(!cookie.verify(inet_addr("192.0.2.8"), 443, tag.source_port, tag.seq + 1),
+              "cookie: another host's reply accepted");
+        check(!other.verify(ip, 443, tag.source_port, tag.seq + 1), "cookie: another key's reply accepted");
+        
+        std::printf("cookie: make and verify checked\n");
+    }
+    
+    // A run of RANGE free loopback ports below the cookies' source ports,
+    // with listening sockets on the LISTENING offsets
+    Port open_listeners(std::vector<int>& listeners) {
+        for (Port base = 20000; base + RANGE < ProbeCookie::SOURCE_PORT_BASE; base += RANGE) {
+            std::vector<int> sockets;
+            for (std::size_t i = 0; i < RANGE; ++i) {
+                const int fd = socket(AF_INET, SOCK_STREAM, 0);
+                const sockaddr_in address = NetworkUtils::create_sockaddr("127.0.0.1", static_cast<Port>(base + i));
+                if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                    close(fd);
+                    break;
+                }
+                sockets.push_back(fd);
+            }
+            
+            if (sockets.size() == RANGE) {
+                for (std::size_t i = 0; i < RANGE; ++i) {
+                    if (std::find(std::begin(LISTENING), std::end(LISTENING), i) != std::end(LISTENING) &&
+                        listen(sockets[i], 16) == 0) {
+                        listeners.push_back(sockets[i]);
+                    } else {
+                        close(sockets[i]);
+                    }
+                }
+                return base;
+            }
+            for (int fd : sockets) {
+                close(fd);
+            }
+        }
+        return 0;
+    }
+    
+    // Sends a copy of the first reply from each scanned port back to the
+    // scanner, and once the first port answers, a SYN-ACK from the last
+    // port that carries the first port's cookie
+    class ReplyInjector {
+    public:
+        ReplyInjector(Port base) : base_(base) {
+            sniff_fd_ = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+            inject_fd_ = socket(AF_INET, SOCK_RAW, IPPROTO_RAW);
+            
+            sockaddr_ll local{};
+            local.sll_family = AF_PACKET;
+            local.sll_protocol = htons(ETH_P_IP);
+            local.sll_ifindex = static_cast<int>(if_nametoindex("lo"));
+            if (sniff_fd_ < 0 || inject_fd_ < 0 ||
+                bind(sniff_fd_, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0) {
+                throw std::runtime_error("cannot open packet sockets");
+            }
+            thread_ = std::thread([this]() { run(); });
+        }
+        
+        ~ReplyInjector() {
+            stop_.store(true);
+            thread_.join();
+            close(sniff_fd_);
+            close(inject_fd_);
+        }
+        
+        std::size_t duplicates() const { return duplicates_.load(); }
+        bool forged() const { return forged_.load(); }
+    
+    private:
+        Port base_;
+        int sniff_fd_ = -1;
+        int inject_fd_ = -1;
+        std::set<Port> replayed_;
+        std::atomic<std::size_t> duplicates_{0};
+        std::atomic<bool> forged_{false};
+        std::atomic<bool> stop_{false};
+        std::thread thread_;
+        
+        void run() {
+            std::uint8_t packet[65536];
+            
+            while (!stop_.load()) {
+                pollfd pfd{sniff_fd_, POLLIN, 0};
+                if (poll(&pfd, 1, 20) <= 0) continue;
+                
+                sockaddr_ll from{};
+                socklen_t from_length = sizeof(from);
+                const ssize_t length = recvfrom(sniff_fd_, packet, sizeof(packet), MSG_DONTWAIT,
+                                                reinterpret_cast<sockaddr*>(&from), &from_length);
+                // Loopback shows each packet leaving and arriving: take one copy
+                if (length <= 0 || from.sll_pkttype == PACKET_OUTGOING) continue;
+                
+                auto* ip = reinterpret_cast<iphdr*>(packet);
+                const std::size_t ip_length = ip->ihl * 4u;
+                if (ip->protocol != IPPROTO_TCP || static_cast<std::size_t>(length) < ip_length + sizeof(tcphdr)) {
+                    continue;
+                }
+                
+                auto* tcp = reinterpret_cast<tcphdr*>(packet + ip_length);
+                const Port port = ntohs(tcp->source);
+                if (port < base_ || port >= base_ + RANGE || ntohs(tcp->dest) < ProbeCookie::SOURCE_PORT_BASE ||
+                    !(tcp->rst || (tcp->syn && tcp->ack)) || !replayed_.insert(port).second) {
+                    continue;
+                }
+                
+                inject(packet, static_cast<std::size_t>(length));
+                duplicates_.fetch_add(1);
+                
+                // The last port is probed last; this reaches the scanner first
+                if (port == base_ && tcp->syn) {
+                    const Port last = static_cast<Port>(base_ + RANGE - 1);
+                    replayed_.insert(last);
+                    tcp->source = htons(last);
+                    tcp->check = 0;
+                    tcp->check = NetworkUtils::transport_checksum(ip->saddr, ip->daddr, IPPROTO_TCP, tcp,
+                                                                  static_cast<std::size_t>(length) - ip_length);
+                    inject(packet, static_cast<std::size_t>(length));
+                    forged_.store(true);
+                }
+            }
+        }
+        
+        void inject(const std::uint8_t* packet, std::size_t length) {
+            const sockaddr_in destination = NetworkUtils::create_sockaddr("127.0.0.1", 0);
+            sendto(inject_fd_, packet, length, 0, reinterpret_cast<const sockaddr*>(&destination),
+                   sizeof(destination));
+        }
+    };
+    
+    // Counts what reaches the sink: each probe must be reported exactly once
+    class CountingSink : public ResultSink {
+    public:
+        void record(const ProbeTarget& probe, const ScanResult&) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++counts_[probe.port];
+        }
+        
+        std::size_t count(Port port) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return counts_[port];
+        }
+    
+    private:
+        std::mutex mutex_;
+        std::map<Port, std::size_t> counts_;
+    };
+    
+    void check_scan(const char* name, Port base, bool rx_ring, bool stateless) {
+        ScanConfig config;
+        config.target = "127.0.0.1";
+        config.targets = {"127.0.0.1"};
+        config.ports = PortSet::parse(std::to_string(base) + "-" + std::to_string(base + RANGE - 1));
+        config.scan_type = ScanType::TCP_SYN;
+        config.rx_ring = rx_ring;
+        config.stateless = stateless;
+        config.randomize = false;
+        config.rate = 50;   // about half a second, so duplicates land mid-scan
+        config.service_detection = false;
+        config.banner_grabbing = false;
+        
+        RawScanner scanner(config);
+        CountingSink sink;
+        scanner.set_sink(&sink);
+        std::size_t most_completed = 0;
+        
+        ScanResults results;
+        std::size_t duplicates = 0;
+        bool forged = false;
+        {
+            ReplyInjector injector(base);
+            results = scanner.scan([&most_completed](std::size_t completed, std::size_t) {
+                most_completed = std::max(most_completed, completed);
+            });
+            duplicates = injector.duplicates();
+            forged = injector.forged();
+        }
+        
+        check(results.total_count() == RANGE, "scan: one result per port");
+        for (std::size_t i = 0; i < results.total_count(); ++i) {
+            const ScanResult& result = results.at(i);
+            const std::size_t offset = result.port - base;
+            const bool listening =
+                std::find(std::begin(LISTENING), std::end(LISTENING), offset) != std::end(LISTENING);
+            const PortStatus expected = listening ? PortStatus::OPEN : PortStatus::CLOSED;
+            
+            if (result.status != expected) {
+                std::printf("FAIL %s: port %u %s, expected %s\n", name, result.port,
+                            ScanResults::status_to_string(result.status).c_str(), ScanResults::status_to_string(expected).c_str());
+                ++failures;
+            }
+            if (sink.count(result.port) != 1) {
+                std::printf("FAIL %s: port %u reported %zu times\n", name, result.port, sink.count(result.port));
+                ++failures;
+            }
+        }
+        
+        if (most_completed > RANGE) {
+            std::printf("FAIL %s: progress reached %zu of %zu\n", name, most_completed, RANGE);
+            ++failures;
+        }
+        if (duplicates == 0 || !forged) {
+            std::printf("FAIL %s: no duplicate or forged reply was sent\n", name);
+            ++failures;
+        }
+        
+        std::printf("%s: %zu ports (receive: %s), %zu replies sent twice\n", name, RANGE,
+                    scanner.stats().receive_path.c_str(), duplicates);
+    }
+}
+
+int main() {
+    check_cookie();
+    
+    const int probe_fd = socket(AF_INET, SOCK_RAW, IPPROTO_RAW);
+    if (probe_fd < 0) {
+        std::printf("loopback scans skipped: no CAP_NET_RAW\n");
+        std::printf("%zu failures\n", failures);
+        return failures == 0 ? SKIPPED : 1;
+    }
+    close(probe_fd);
+    
+    std::vector<int> listeners;
+    const Port base = open_listeners(listeners);
+    if (base == 0) {
+        std::printf("FAIL no free run of %zu loopback ports\n", RANGE);
+        return 1;
+    }
+    
+    try {
+        check_scan("ring", base, true, false);
+        check_scan("socket", base, false, false);
+        check_scan("stateless", base, true, true);
+    } catch (const std::exception& e) {
+        std::printf("FAIL %s\n", e.what());
+        ++failures;
+    }
+    
+    for (int fd : listeners) {
+        close(fd);
+    }
+    
+    std::printf("%zu failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}